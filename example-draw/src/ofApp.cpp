@@ -2,10 +2,10 @@
 
 //--------------------------------------------------------------
 void ofApp::setup(){
-    bezierEditor.setRibbonWidth(30);
-    bezierEditor.setUseRibbonMesh(true);
-    bezierEditor.setClosed(false);
-    bezierEditor.setHasRoundCaps(true);
+    meshSettings.setRibbonWidth(30);
+    meshSettings.setUseRibbonMesh(true);
+    meshSettings.setClosed(false);
+    meshSettings.setHasRoundCaps(true);
 }
 
 //--------------------------------------------------------------
@@ -16,8 +16,8 @@ void ofApp::update(){
 //--------------------------------------------------------------
 void ofApp::draw(){
     if(ofGetMousePressed()){
-        ofSetColor(255, 0, 0);
-        drawLine.draw();
+        ofSetColor(0, 255, 0);
+        strokeBuilder.draw();
     }
     else{
         ofSetColor(0, 255, 0);
@@ -33,7 +33,7 @@ void ofApp::exit(){
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key){
     if(key == 'c'){
-        drawLine.clear();
+        strokeBuilder.clear();
         ribbonMesh.clear();
     }
 }
@@ -50,17 +50,29 @@ void ofApp::mouseMoved(int x, int y ){
 
 //--------------------------------------------------------------
 void ofApp::mouseDragged(int x, int y, int button){
-    drawLine.addVertex(x, y);
+    strokeBuilder.addPoint(glm::vec3(x, y, 0));
 }
 
 //--------------------------------------------------------------
 void ofApp::mousePressed(int x, int y, int button){
+    strokeBuilder.clear();
+    strokeBuilder.addPoint(glm::vec3(x, y, 0));
 
 }
 
 //--------------------------------------------------------------
 void ofApp::mouseReleased(int x, int y, int button){
-    ribbonMesh = bezierEditor.getTubeMeshFromPolyline(drawLine);
+    // fit a handful of bezier segments to the raw samples and mesh those instead of every sample
+    std::vector<ofxBezierCurveFitter::Segment> segments;
+    ofxBezierCurveFitter::FitCurve(strokeBuilder.getPoints(), 2.0, 60, segments);
+    ofPolyline fitted;
+    for(const auto & segment : segments){
+        if(fitted.size() == 0){
+            fitted.addVertex(segment.p0.x, segment.p0.y);
+        }
+        fitted.bezierTo(segment.c1.x, segment.c1.y, segment.c2.x, segment.c2.y, segment.p1.x, segment.p1.y);
+    }
+    ofxBezierRibbonMeshBuilder::BuildRibbonMesh(fitted, meshSettings, ribbonMesh);
     cout<<"Released"<<endl;
 }
 
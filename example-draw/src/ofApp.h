@@ -1,7 +1,9 @@
 #pragma once
 
 #include "ofMain.h"
-#include "ofxBezierEditor.h"
+#include "ofxBezierRibbonMeshBuilder.h"
+#include "ofxBezierCurveFitter.h"
+#include "ofxBezierStrokeBuilder.h"
 
 
 
@@ -27,7 +29,9 @@ class ofApp : public ofBaseApp{
 		void gotMessage(ofMessage msg) override;
     
         ofVboMesh ribbonMesh;
-    ofPolyline drawLine;
-    ofxBezierEditor bezierEditor;
+    // no editor needed, strokes are fitted and meshed with the static functions
+    ofxBezierMeshSettings meshSettings;
+    // meshes the stroke as it is drawn, so it looks like the final ribbon while the mouse is down
+    ofxBezierStrokeBuilder strokeBuilder = ofxBezierStrokeBuilder(meshSettings);
 		
 };
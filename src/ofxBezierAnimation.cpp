@@ -0,0 +1,122 @@
+//
+//  ofxBezierAnimation.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierAnimation.h"
+
+namespace {
+	bool trackOrder(const ofxBezierAnimation::Track & track, const std::pair <int, int> & key){
+		return std::make_pair(track.index, (int)track.handle) < key;
+	}
+
+	bool keyOrder(float time, const ofxBezierAnimation::Keyframe & key){
+		return time < key.time;
+	}
+}
+
+ofxBezierAnimation::ofxBezierAnimation(){
+}
+
+ofxBezierAnimation::Track & ofxBezierAnimation::getTrack(int index, Handle handle){
+	// tracks are kept sorted by handle so keying a whole shape doesn't search the list every time
+	std::pair <int, int> key(index, (int)handle);
+	auto found = std::lower_bound(tracks.begin(), tracks.end(), key, trackOrder);
+	if(found == tracks.end() || found->index != index || found->handle != handle){
+		found = tracks.insert(found, Track());
+		found->index = index;
+		found->handle = handle;
+		found->interpolation = interpolation;
+	}
+	return *found;
+}
+
+void ofxBezierAnimation::setKeyframe(int index, Handle handle, float time, const glm::vec2 & position){
+	Track & track = getTrack(index, handle);
+	auto next = std::upper_bound(track.keys.begin(), track.keys.end(), time, keyOrder);
+	if(next != track.keys.begin() && (next - 1)->time == time){
+		(next - 1)->position = position;
+	}else{
+		Keyframe keyframe;
+		keyframe.time = time;
+		keyframe.position = position;
+		track.keys.insert(next, keyframe);
+	}
+	track.bStatic = std::all_of(track.keys.begin(), track.keys.end(), [&](const Keyframe & key){
+		return key.position == track.keys.front().position;
+	});
+	duration = std::max(duration, time);
+}
+
+void ofxBezierAnimation::setKeyframes(float time, const std::vector <draggableVertex> & curveVertices, const std::vector <draggableVertex> & controlPoint1,
+									  const std::vector <draggableVertex> & controlPoint2){
+	for(int i = 0; i < curveVertices.size(); i++){
+		setKeyframe(i, VERTEX, time, curveVertices[i].pos);
+		if(i < controlPoint1.size()){
+			setKeyframe(i, CONTROL_1, time, controlPoint1[i].pos);
+		}
+		if(i < controlPoint2.size()){
+			setKeyframe(i, CONTROL_2, time, controlPoint2[i].pos);
+		}
+	}
+}
+
+void ofxBezierAnimation::removeTrack(int index, Handle handle){
+	tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [&](const Track & track){
+		return track.index == index && track.handle == handle;
+	}), tracks.end());
+	duration = 0;
+	for(const auto & track : tracks){
+		duration = std::max(duration, track.keys.back().time);
+	}
+}
+
+void ofxBezierAnimation::clear(){
+	tracks.clear();
+	duration = 0;
+}
+
+glm::vec2 ofxBezierAnimation::evaluate(const Track & track, float time) const {
+	if(bLoop && duration > 0){
+		time = std::fmod(time, duration);
+		if(time < 0){
+			time += duration;
+		}
+	}
+	auto next = std::upper_bound(track.keys.begin(), track.keys.end(), time, keyOrder);
+	if(next == track.keys.begin()){
+		return track.keys.front().position;
+	}
+	if(next == track.keys.end()){
+		return track.keys.back().position;
+	}
+	const Keyframe & previous = *(next - 1);
+	float t = (time - previous.time) / (next->time - previous.time);
+	if(track.interpolation == STEP){
+		return previous.position;
+	}else if(track.interpolation == SMOOTH){
+		t = t * t * (3 - 2 * t);
+	}
+	return glm::mix(previous.position, next->position, t);
+}
+
+int ofxBezierAnimation::evaluate(float time, std::vector <draggableVertex> & curveVertices, std::vector <draggableVertex> & controlPoint1,
+								 std::vector <draggableVertex> & controlPoint2) const {
+	int moved = 0;
+	for(const auto & track : tracks){
+		if(track.bStatic){
+			continue;
+		}
+		std::vector <draggableVertex> & points = (track.handle == VERTEX) ? curveVertices : (track.handle == CONTROL_1 ? controlPoint1 : controlPoint2);
+		if(track.index >= points.size()){
+			continue;
+		}
+		glm::vec2 position = evaluate(track, time);
+		// handles that didn't move leave their segments alone
+		if(points[track.index].pos != position){
+			points[track.index].pos = position;
+			moved++;
+		}
+	}
+	return moved;
+}
@@ -0,0 +1,95 @@
+//
+//  ofxBezierAnimation.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "draggableVertex.h"
+
+// Keyframe tracks for the points of a curve, one per animated handle (a vertex or one of its two
+// control points). Handles without a track, or whose keys are all the same, are never written, so
+// evaluating only touches what moves and the segments around the other handles stay as they are.
+// Times are in seconds; before the first key and after the last the track holds its end value,
+// unless the animation loops.
+class ofxBezierAnimation {
+	public:
+		enum Handle {
+			VERTEX,
+			CONTROL_1,
+			CONTROL_2
+		};
+
+		enum Interpolation {
+			LINEAR,
+			// eases in and out of every key
+			SMOOTH,
+			// jumps to each key when its time comes
+			STEP
+		};
+
+		struct Keyframe {
+			float time = 0;
+			glm::vec2 position;
+		};
+
+		struct Track {
+			int index = 0;
+			Handle handle = VERTEX;
+			Interpolation interpolation = LINEAR;
+			// sorted by time, at most one key per time
+			std::vector <Keyframe> keys;
+			// all keys at the same position, nothing to animate
+			bool bStatic = true;
+		};
+
+		ofxBezierAnimation();
+
+		// Adds a key, replacing one at the same time
+		void setKeyframe(int index, Handle handle, float time, const glm::vec2 & position);
+		// Keys every handle at time, e.g. the points of a file loaded with loadPoints()
+		void setKeyframes(float time, const std::vector <draggableVertex> & curveVertices, const std::vector <draggableVertex> & controlPoint1,
+						  const std::vector <draggableVertex> & controlPoint2);
+		void removeTrack(int index, Handle handle);
+		void clear();
+
+		// for the tracks added from now on
+		void setInterpolation(Interpolation value){
+			interpolation = value;
+		}
+		Interpolation getInterpolation() const {
+			return interpolation;
+		}
+		void setLoop(bool value){
+			bLoop = value;
+		}
+		bool getLoop() const {
+			return bLoop;
+		}
+
+		// from 0 to the last key
+		float getDuration() const {
+			return duration;
+		}
+		const std::vector <Track> & getTracks() const {
+			return tracks;
+		}
+		bool empty() const {
+			return tracks.empty();
+		}
+
+		// Writes the animated handles at time into the points, returns how many of them moved.
+		// Tracks for handles the points don't have are skipped.
+		int evaluate(float time, std::vector <draggableVertex> & curveVertices, std::vector <draggableVertex> & controlPoint1,
+					 std::vector <draggableVertex> & controlPoint2) const;
+		glm::vec2 evaluate(const Track & track, float time) const;
+
+	private:
+		Track & getTrack(int index, Handle handle);
+
+		std::vector <Track> tracks;
+		Interpolation interpolation = LINEAR;
+		bool bLoop = false;
+		float duration = 0;
+};
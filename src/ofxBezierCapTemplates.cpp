@@ -0,0 +1,51 @@
+//
+//  ofxBezierCapTemplates.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierCapTemplates.h"
+
+namespace {
+	// as many as ofxBezierRibbonMeshBuilder always used
+	const int ribbonCapPoints = 20;
+
+	std::mutex tubeCapMutex;
+	std::map <int, std::unique_ptr <ofxBezierCapTemplates::TubeCap> > tubeCaps;
+}
+
+const ofxBezierCapTemplates::TubeCap & ofxBezierCapTemplates::GetTubeCap(int resolution){
+	resolution = std::max(resolution, 1);
+	std::lock_guard <std::mutex> lock(tubeCapMutex);
+	auto & cap = tubeCaps[resolution];
+	if(!cap){
+		cap = std::make_unique <TubeCap>();
+		cap->resolution = resolution;
+		for(int j = 0; j <= resolution; j++){
+			float angle = TWO_PI * j / resolution;
+			cap->ringCos.push_back(cos(angle));
+			cap->ringSin.push_back(sin(angle));
+		}
+		// rings evenly spaced along the tangent, as the tube builder always placed them
+		for(int i = 0; i <= resolution + 1; i++){
+			float offset = i / static_cast <float>(resolution + 1);
+			cap->hemisphereOffsets.push_back(offset);
+			cap->hemisphereRadii.push_back(sqrt(std::max(1 - offset * offset, 0.0f)));
+		}
+	}
+	return *cap;
+}
+
+const ofxBezierCapTemplates::RibbonCap & ofxBezierCapTemplates::GetRibbonCap(){
+	// made once, function local statics are thread safe
+	static const RibbonCap cap = [](){
+		RibbonCap result;
+		float angleStep = 180.0f / ribbonCapPoints;
+		for(int i = 0; i <= ribbonCapPoints; i++){
+			float angle = ofDegToRad(90 + angleStep * i);
+			result.cosines.push_back(cos(angle));
+			result.sines.push_back(sin(angle));
+		}
+		return result;
+	}();
+	return cap;
+}
@@ -0,0 +1,39 @@
+//
+//  ofxBezierCapTemplates.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+// Unit geometry for the ends of ribbons and tubes. A cap only depends on the tube resolution
+// (ribbon caps always have the same number of points), so the trig is done once per resolution
+// for the whole process and the builders only scale and orient the templates into place.
+// Safe to call from several threads, the templates are never changed once made.
+class ofxBezierCapTemplates {
+	public:
+		struct TubeCap {
+			int resolution = 0;
+			// around a ring, resolution + 1 entries so the seam vertex is repeated
+			std::vector <float> ringCos;
+			std::vector <float> ringSin;
+			// hemisphere rings from the equator (0) to the pole (resolution + 1), as fractions of the radius:
+			// how far the ring sits along the tangent and how wide it is
+			std::vector <float> hemisphereOffsets;
+			std::vector <float> hemisphereRadii;
+		};
+
+		struct RibbonCap {
+			// the half circle of a forwards cap, from 90 to 270 degrees. Backwards caps are the same points negated.
+			std::vector <float> cosines;
+			std::vector <float> sines;
+		};
+
+		static const TubeCap & GetTubeCap(int resolution);
+		static const RibbonCap & GetRibbonCap();
+
+	private:
+		ofxBezierCapTemplates(){
+		}
+};
@@ -0,0 +1,442 @@
+//
+//  ofxBezierChunkedMesh.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierChunkedMesh.h"
+#include "ofxBezierUtility.h"
+#include "ofxBezierCapTemplates.h"
+
+namespace {
+	// same as the tessellated polyline, ofPolyline::bezierTo makes 20 points per segment
+	const int samplesPerSegment = 20;
+
+	bool isSameShape(const ofxBezierMeshSettings & a, const ofxBezierMeshSettings & b){
+		return a.bIsClosed == b.bIsClosed && a.meshLengthPrecisionMultiplier == b.meshLengthPrecisionMultiplier &&
+			   a.ribbonWidth == b.ribbonWidth && a.tubeResolution == b.tubeResolution && a.tubeRadius == b.tubeRadius &&
+			   a.roundCap == b.roundCap && a.bArcLengthSampling == b.bArcLengthSampling && a.sampleSpacing == b.sampleSpacing &&
+			   a.curvatureWeight == b.curvatureWeight && a.bMeshNormals == b.bMeshNormals && a.bMeshTexCoords == b.bMeshTexCoords;
+	}
+
+	// direction of the curve at t on a segment. At the vertices both segments that meet there are
+	// averaged, so the chunks on either side of a vertex end up with exactly the same ring.
+	glm::vec2 getDirection(const std::vector <ofxBezierSegmentTree::Segment> & segments, int index, float t, bool closed){
+		auto direction = [&](int i, float at){
+			const ofxBezierSegmentTree::Segment & s = segments[i];
+			return ofxBezierUtility::EvaluateSegmentTangent(s.p0, s.c1, s.c2, s.p1, at);
+		};
+		int count = segments.size();
+		int neighbour = -1;
+		if(t <= 0){
+			neighbour = (index > 0) ? index - 1 : (closed ? count - 1 : -1);
+		}else if(t >= 1){
+			neighbour = (index < count - 1) ? index + 1 : (closed ? 0 : -1);
+		}
+		if(neighbour < 0 || neighbour == index){
+			return direction(index, t);
+		}
+		glm::vec2 sum = direction(index, t) + direction(neighbour, t <= 0 ? 1 : 0);
+		if(glm::length2(sum) < 1e-12){
+			// the curve turns right back on itself, keep our own side
+			return direction(index, t);
+		}
+		return glm::normalize(sum);
+	}
+}
+
+ofxBezierChunkedMesh::ofxBezierChunkedMesh(Type type) : type(type){
+}
+
+ofxBezierChunkedMesh::~ofxBezierChunkedMesh(){
+}
+
+void ofxBezierChunkedMesh::setType(Type value){
+	if(value != type){
+		type = value;
+		clear();
+	}
+}
+
+bool ofxBezierChunkedMesh::isComplete() const {
+	return std::find(dirtyChunks.begin(), dirtyChunks.end(), true) == dirtyChunks.end();
+}
+
+void ofxBezierChunkedMesh::clear(){
+	chunks.clear();
+	buffers.clear();
+	builtRevisions.clear();
+	dirtyChunks.clear();
+	chunkSize = 0;
+	mesh.clear();
+	bMeshDirty = true;
+}
+
+int ofxBezierChunkedMesh::update(const ofxBezierSegmentTree & tree, const ofxBezierMeshSettings & settings, uint64_t budgetMicros){
+	const auto & segments = tree.getSegments();
+	if(segments.empty()){
+		if(!chunks.empty()){
+			clear();
+		}
+		return 0;
+	}
+
+	uint64_t startMicros = ofGetElapsedTimeMicros();
+	int size = tree.getLeafSize();
+	int count = (segments.size() + size - 1) / size;
+	bool bLayoutChanged = count != chunks.size() || size != chunkSize || segments.size() != builtRevisions.size();
+	if(bLayoutChanged){
+		chunks.assign(count, Chunk());
+		buffers.clear();
+		buffers.resize(count);
+		builtRevisions.assign(segments.size(), 0);
+		dirtyChunks.assign(count, true);
+		chunkSize = size;
+	}
+	// new settings redo every chunk, but the old ones stay drawable until they are replaced
+	bool bSettingsChanged = !isSameShape(settings, builtSettings);
+	builtSettings = settings;
+
+	// a chunk depends on its own segments and on the first and last ring, which also look at the neighbours
+	int segmentCount = segments.size();
+	for(int i = 0; i < count; i++){
+		if(dirtyChunks[i] || bSettingsChanged){
+			dirtyChunks[i] = true;
+			continue;
+		}
+		int first = i * size;
+		int last = std::min(first + size, segmentCount) - 1;
+		for(int s = first - 1; s <= last + 1; s++){
+			int index = s;
+			if(index < 0 || index >= segmentCount){
+				if(!settings.bIsClosed){
+					continue;
+				}
+				index = (index + segmentCount) % segmentCount;
+			}
+			if(segments[index].revision != builtRevisions[index]){
+				dirtyChunks[i] = true;
+				break;
+			}
+		}
+	}
+
+	int rebuilt = 0;
+	for(int i = 0; i < count; i++){
+		chunks[i].firstSegment = i * size;
+		chunks[i].segmentCount = std::min(size, segmentCount - i * size);
+		if(dirtyChunks[i]){
+			if(budgetMicros > 0 && rebuilt > 0 && ofGetElapsedTimeMicros() - startMicros > budgetMicros){
+				continue;
+			}
+			buildChunk(i, tree, settings);
+			buffers[i].bGeometryDirty = true;
+			dirtyChunks[i] = false;
+			rebuilt++;
+		}
+	}
+	for(int i = 0; i < segmentCount; i++){
+		builtRevisions[i] = segments[i].revision;
+	}
+
+	// rebuilt chunks start at 0, the others only move if something before them changed length
+	bool bShifted = false;
+	float start = getCapLength();
+	for(int i = 0; i < count; i++){
+		Chunk & chunk = chunks[i];
+		if(chunk.startLength != start){
+			float shift = start - chunk.startLength;
+			for(auto & texCoord : chunk.texCoords){
+				texCoord.y += shift;
+			}
+			chunk.startLength = start;
+			if(!buffers[i].bGeometryDirty){
+				buffers[i].bTexCoordsDirty = true;
+			}
+			bShifted = true;
+		}
+		start += chunk.length;
+	}
+
+	if(rebuilt > 0 || bShifted){
+		bMeshDirty = true;
+	}
+	return rebuilt;
+}
+
+float ofxBezierChunkedMesh::getCapLength() const {
+	if(builtSettings.bIsClosed || !builtSettings.roundCap){
+		return 0;
+	}
+	return type == TUBE ? builtSettings.tubeRadius : builtSettings.ribbonWidth * 0.5;
+}
+
+void ofxBezierChunkedMesh::buildChunk(int index, const ofxBezierSegmentTree & tree, const ofxBezierMeshSettings & settings){
+	const auto & segments = tree.getSegments();
+	Chunk & chunk = chunks[index];
+	chunk.vertices.clear();
+	chunk.normals.clear();
+	chunk.texCoords.clear();
+
+	// sample the segments, the first point of every segment after the first is the last one of the segment before
+	samplePoints.clear();
+	sampleTangents.clear();
+	sampleLengths.clear();
+	int steps = samplesPerSegment * std::max(settings.meshLengthPrecisionMultiplier, 1);
+	float length = 0;
+	for(int s = chunk.firstSegment; s < chunk.firstSegment + chunk.segmentCount; s++){
+		const ofxBezierSegmentTree::Segment & segment = segments[s];
+		// with arc length sampling every segment gets its own count, which only depends on the segment itself
+		if(settings.bArcLengthSampling){
+			ofxBezierUtility::CalculateSegmentArcLengthParameters(segment.p0, segment.c1, segment.c2, segment.p1, settings.sampleSpacing, settings.curvatureWeight, sampleParameters);
+			steps = sampleParameters.size() - 1;
+		}
+		for(int k = (s == chunk.firstSegment) ? 0 : 1; k <= steps; k++){
+			float t = settings.bArcLengthSampling ? sampleParameters[k] : k / static_cast <float>(steps);
+			glm::vec2 point = (k == 0) ? segment.p0 : (k == steps) ? segment.p1 : ofxBezierUtility::EvaluateSegment(segment.p0, segment.c1, segment.c2, segment.p1, t);
+			if(!samplePoints.empty()){
+				length += glm::distance(point, samplePoints.back());
+			}
+			samplePoints.push_back(point);
+			sampleTangents.push_back(getDirection(segments, s, t, settings.bIsClosed));
+			sampleLengths.push_back(length);
+		}
+	}
+	chunk.length = length;
+	// texture coordinates are relative to the chunk until update() moves them into place
+	chunk.startLength = 0;
+
+	bool bStartCap = index == 0 && !settings.bIsClosed;
+	bool bEndCap = index == chunks.size() - 1 && !settings.bIsClosed;
+
+	if(type == TUBE){
+		tubeCap = &ofxBezierCapTemplates::GetTubeCap(settings.tubeResolution);
+
+		ringVertices.clear();
+		ringNormals.clear();
+		ringTexCoords.clear();
+		if(bStartCap){
+			addTubeCap(samplePoints.front(), sampleTangents.front(), true, 0);
+		}
+		for(int i = 0; i < samplePoints.size(); i++){
+			addTubeRing(samplePoints[i], sampleTangents[i], settings.tubeRadius, sampleLengths[i], samplePoints[i]);
+		}
+		if(bEndCap){
+			addTubeCap(samplePoints.back(), sampleTangents.back(), false, length);
+		}
+		connectTubeRings(chunk);
+	}else{
+		float halfWidth = settings.ribbonWidth * 0.5;
+		if(bStartCap && settings.roundCap){
+			addRibbonCap(chunk, samplePoints.front(), sampleTangents.front(), true, 0);
+		}
+		for(int i = 0; i < samplePoints.size(); i++){
+			glm::vec2 perpendicular(-sampleTangents[i].y, sampleTangents[i].x);
+			chunk.vertices.push_back(glm::vec3(samplePoints[i] - perpendicular * halfWidth, 0));
+			chunk.texCoords.push_back(glm::vec2(0, sampleLengths[i]));
+			chunk.vertices.push_back(glm::vec3(samplePoints[i] + perpendicular * halfWidth, 0));
+			chunk.texCoords.push_back(glm::vec2(1, sampleLengths[i]));
+		}
+		if(bEndCap && settings.roundCap){
+			addRibbonCap(chunk, samplePoints.back(), sampleTangents.back(), false, length);
+		}
+	}
+
+	// attributes the settings leave out are built anyway (the rings need them) and dropped here
+	if(!settings.bMeshNormals){
+		chunk.normals.clear();
+	}
+	if(!settings.bMeshTexCoords){
+		chunk.texCoords.clear();
+	}
+}
+
+void ofxBezierChunkedMesh::addTubeRing(const glm::vec2 & center, const glm::vec2 & tangent, float radius, float v, const glm::vec2 & normalOrigin, float flatSide){
+	// the ring lies in the plane across the tangent: the in-plane normal and the z axis
+	glm::vec3 normal(-tangent.y, tangent.x, 0);
+	glm::vec3 binormal(0, 0, 1);
+	int resolution = tubeCap->resolution;
+	for(int j = 0; j <= resolution; j++){
+		glm::vec3 radial = normal * tubeCap->ringCos[j] + binormal * tubeCap->ringSin[j];
+		glm::vec3 vertex = glm::vec3(center, 0) + radial * radius;
+		ringVertices.push_back(vertex);
+		if(flatSide != 0){
+			ringNormals.push_back(glm::vec3(tangent * flatSide, 0));
+		}else{
+			glm::vec3 away = vertex - glm::vec3(normalOrigin, 0);
+			ringNormals.push_back(glm::length2(away) > 0 ? glm::normalize(away) : radial);
+		}
+		ringTexCoords.push_back(glm::vec2(j / static_cast <float>(resolution), v));
+	}
+}
+
+void ofxBezierChunkedMesh::addTubeCap(const glm::vec2 & center, const glm::vec2 & tangent, bool forwards, float v){
+	float radius = builtSettings.tubeRadius;
+	int resolution = tubeCap->resolution;
+	if(builtSettings.roundCap){
+		// a hemisphere of rings from the shared template, pole first at the start and last at the end
+		int pole = tubeCap->hemisphereOffsets.size() - 1;
+		for(int k = 1; k <= pole; k++){
+			int i = forwards ? pole + 1 - k : k;
+			float offset = tubeCap->hemisphereOffsets[i] * radius;
+			float ringRadius = tubeCap->hemisphereRadii[i] * radius;
+			if(forwards){
+				addTubeRing(center - tangent * offset, tangent, ringRadius, v - offset, center);
+			}else{
+				addTubeRing(center + tangent * offset, tangent, ringRadius, v + offset, center);
+			}
+		}
+	}else{
+		// a disc of shrinking rings
+		if(forwards){
+			for(int i = 0; i < resolution; i++){
+				addTubeRing(center, tangent, radius / resolution * i, v, center, -1);
+			}
+		}else{
+			for(int i = resolution - 1; i >= 0; i--){
+				addTubeRing(center, tangent, radius / resolution * i, v, center, 1);
+			}
+		}
+	}
+}
+
+void ofxBezierChunkedMesh::connectTubeRings(Chunk & chunk){
+	int ringSize = tubeCap->ringCos.size();
+	int ringCount = ringVertices.size() / ringSize;
+	chunk.vertices.reserve(std::max(ringCount - 1, 0) * ringSize * 2);
+	for(int i = 0; i < ringCount - 1; i++){
+		int ring = i * ringSize;
+		int next = ring + ringSize;
+		for(int j = 0; j < ringSize; j++){
+			chunk.vertices.push_back(ringVertices[ring + j]);
+			chunk.vertices.push_back(ringVertices[next + j]);
+			chunk.normals.push_back(ringNormals[ring + j]);
+			chunk.normals.push_back(ringNormals[next + j]);
+			chunk.texCoords.push_back(ringTexCoords[ring + j]);
+			chunk.texCoords.push_back(ringTexCoords[next + j]);
+		}
+	}
+}
+
+void ofxBezierChunkedMesh::addRibbonCap(Chunk & chunk, const glm::vec2 & center, const glm::vec2 & tangent, bool forwards, float v){
+	// a half circle fanned around the end point, laid out as in ofxBezierRibbonMeshBuilder
+	float halfWidth = builtSettings.ribbonWidth * 0.5;
+	glm::vec2 normal(-tangent.y, tangent.x);
+	const ofxBezierCapTemplates::RibbonCap & cap = ofxBezierCapTemplates::GetRibbonCap();
+	float direction = forwards ? 1 : -1;
+	for(int i = 0; i < cap.cosines.size(); i++){
+		float cosAngle = cap.cosines[i] * direction;
+		float sinAngle = cap.sines[i] * direction;
+		glm::vec2 point = center + tangent * (cosAngle * halfWidth) + normal * (sinAngle * halfWidth);
+		float along = abs(halfWidth * cosAngle);
+		chunk.vertices.push_back(glm::vec3(point, 0));
+		chunk.vertices.push_back(glm::vec3(center, 0));
+		chunk.texCoords.push_back(glm::vec2(0.5 + 0.5 * sinAngle, forwards ? v - along : v + along));
+		chunk.texCoords.push_back(glm::vec2(0.5, v));
+	}
+}
+
+//--------------------------------------------------------------
+void ofxBezierChunkedMesh::syncVbos(){
+	if(vbos.size() != chunks.size()){
+		vbos.resize(chunks.size());
+	}
+}
+
+void ofxBezierChunkedMesh::upload(int index){
+	Buffer & buffer = buffers[index];
+	const Chunk & chunk = chunks[index];
+	ofVbo & vbo = vbos[index];
+	if(buffer.bGeometryDirty){
+		vbo.setVertexData(chunk.vertices.data(), chunk.vertices.size(), GL_DYNAMIC_DRAW);
+		if(!chunk.normals.empty()){
+			vbo.setNormalData(chunk.normals.data(), chunk.normals.size(), GL_DYNAMIC_DRAW);
+		}else{
+			vbo.disableNormals();
+		}
+		if(!chunk.texCoords.empty()){
+			vbo.setTexCoordData(chunk.texCoords.data(), chunk.texCoords.size(), GL_DYNAMIC_DRAW);
+		}else{
+			vbo.disableTexCoords();
+		}
+		buffer.bGeometryDirty = false;
+		buffer.bTexCoordsDirty = false;
+	}else if(buffer.bTexCoordsDirty && !chunk.texCoords.empty()){
+		vbo.updateTexCoordData(chunk.texCoords.data(), chunk.texCoords.size());
+		buffer.bTexCoordsDirty = false;
+	}
+}
+
+void ofxBezierChunkedMesh::draw(){
+	syncVbos();
+	for(int i = 0; i < chunks.size(); i++){
+		if(chunks[i].vertices.empty()){
+			continue;
+		}
+		upload(i);
+		vbos[i].draw(GL_TRIANGLE_STRIP, 0, chunks[i].vertices.size());
+	}
+}
+
+void ofxBezierChunkedMesh::draw(const ofxBezierSegmentTree & tree, const ofRectangle & viewport){
+	if(tree.getLeafSize() != chunkSize || tree.getSegments().size() != builtRevisions.size()){
+		draw();
+		return;
+	}
+	// the leaves bound the curve itself, the mesh sticks out of it
+	float margin = (type == TUBE) ? builtSettings.tubeRadius : builtSettings.ribbonWidth * 0.5;
+	ofRectangle area(viewport.x - margin, viewport.y - margin, viewport.width + margin * 2, viewport.height + margin * 2);
+	visibleLeaves.clear();
+	tree.queryLeaves(area, visibleLeaves);
+
+	syncVbos();
+	const auto & nodes = tree.getNodes();
+	for(int leaf : visibleLeaves){
+		int index = nodes[leaf].first / chunkSize;
+		if(index >= chunks.size() || chunks[index].vertices.empty()){
+			continue;
+		}
+		upload(index);
+		vbos[index].draw(GL_TRIANGLE_STRIP, 0, chunks[index].vertices.size());
+	}
+}
+
+const ofVboMesh & ofxBezierChunkedMesh::getMesh(){
+	if(bMeshDirty){
+		mesh.clear();
+		mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+		for(const Chunk & chunk : chunks){
+			if(chunk.vertices.empty()){
+				continue;
+			}
+			bool bJoin = mesh.getNumVertices() > 0;
+			if(bJoin){
+				// repeat the last vertex and the next first one, the triangles in between have no area
+				mesh.addVertex(mesh.getVertices().back());
+				mesh.addVertex(chunk.vertices.front());
+				if(!chunk.texCoords.empty()){
+					mesh.addTexCoord(mesh.getTexCoords().back());
+					mesh.addTexCoord(chunk.texCoords.front());
+				}
+				if(!chunk.normals.empty()){
+					mesh.addNormal(mesh.getNormals().back());
+					mesh.addNormal(chunk.normals.front());
+				}
+			}
+			mesh.addVertices(chunk.vertices);
+			mesh.addTexCoords(chunk.texCoords);
+			if(!chunk.normals.empty()){
+				mesh.addNormals(chunk.normals);
+			}
+		}
+		bMeshDirty = false;
+	}
+	return mesh;
+}
+
+size_t ofxBezierChunkedMesh::getVertexCount() const {
+	size_t count = 0;
+	for(const Chunk & chunk : chunks){
+		count += chunk.vertices.size();
+	}
+	return count;
+}
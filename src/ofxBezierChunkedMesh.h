@@ -0,0 +1,110 @@
+//
+//  ofxBezierChunkedMesh.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxBezierMeshSettings.h"
+#include "ofxBezierSegmentTree.h"
+#include "ofxBezierCapTemplates.h"
+
+// A ribbon or tube split into chunks that follow the leaves of a segment tree: chunk i covers the
+// segments of leaf i and has its own vertex buffer. The chunks are sampled straight from the cubic
+// segments, so an edit only rebuilds and re-uploads the chunks whose segments (or the neighbours that
+// share their end rings) changed. Neighbouring chunks repeat the ring where they meet, computed from
+// the same data on both sides, so there are no seams. The v texture coordinate is the length along
+// the curve in curve units; when a chunk gets longer or shorter only the texture coordinates of the
+// chunks after it are shifted.
+class ofxBezierChunkedMesh {
+	public:
+		enum Type {
+			RIBBON,
+			TUBE
+		};
+
+		struct Chunk {
+			int firstSegment = 0;
+			int segmentCount = 0;
+			// length along the curve where the chunk starts (including the start cap) and of its own segments
+			float startLength = 0;
+			float length = 0;
+			std::vector <glm::vec3> vertices;
+			std::vector <glm::vec3> normals;
+			std::vector <glm::vec2> texCoords;
+		};
+
+		ofxBezierChunkedMesh(Type type = TUBE);
+		~ofxBezierChunkedMesh();
+
+		void setType(Type value);
+		Type getType() const {
+			return type;
+		}
+
+		// Brings the chunks up to date with the tree and settings, returns how many were rebuilt.
+		// The simplify tolerance doesn't apply, the segments are sampled directly.
+		// With a budget, chunks stop being rebuilt once it is used up and the rest are left for the
+		// next call; until isComplete() the old chunks are drawn next to the new ones.
+		int update(const ofxBezierSegmentTree & tree, const ofxBezierMeshSettings & settings, uint64_t budgetMicros = 0);
+		bool isComplete() const;
+		void clear();
+
+		void draw();
+		// Only the chunks whose segments are near viewport, tree must be the one the chunks were built from
+		void draw(const ofxBezierSegmentTree & tree, const ofRectangle & viewport);
+
+		// All chunks in one triangle strip, joined with degenerate triangles. Built on request and kept until the next change.
+		const ofVboMesh & getMesh();
+
+		const std::vector <Chunk> & getChunks() const {
+			return chunks;
+		}
+		size_t getVertexCount() const;
+
+	private:
+		// what every chunk still has to upload, the vertex buffers themselves are kept apart in vbos
+		struct Buffer {
+			bool bGeometryDirty = true;
+			bool bTexCoordsDirty = false;
+		};
+
+		void buildChunk(int index, const ofxBezierSegmentTree & tree, const ofxBezierMeshSettings & settings);
+		// rings are collected in ringVertices/ringNormals/ringTexCoords and then stitched into the chunk's strip
+		// normals point away from normalOrigin, or along the tangent times flatSide for the discs of flat caps
+		void addTubeRing(const glm::vec2 & center, const glm::vec2 & tangent, float radius, float v, const glm::vec2 & normalOrigin, float flatSide = 0);
+		void addTubeCap(const glm::vec2 & center, const glm::vec2 & tangent, bool forwards, float v);
+		void connectTubeRings(Chunk & chunk);
+		void addRibbonCap(Chunk & chunk, const glm::vec2 & center, const glm::vec2 & tangent, bool forwards, float v);
+		// vbos are only made, resized and freed here, from draw(), so update() and clear() never touch GL objects
+		void syncVbos();
+		void upload(int index);
+		float getCapLength() const;
+
+		Type type;
+		std::vector <Chunk> chunks;
+		std::vector <Buffer> buffers;
+		std::vector <ofVbo> vbos;
+		// revision of every segment when its chunk was last built
+		std::vector <unsigned int> builtRevisions;
+		// the settings the chunks were built with, any change rebuilds everything
+		ofxBezierMeshSettings builtSettings;
+		int chunkSize = 0;
+
+		// scratch space reused between chunks
+		std::vector <glm::vec2> samplePoints;
+		std::vector <glm::vec2> sampleTangents;
+		std::vector <float> sampleLengths;
+		std::vector <float> sampleParameters;
+		std::vector <glm::vec3> ringVertices;
+		std::vector <glm::vec3> ringNormals;
+		std::vector <glm::vec2> ringTexCoords;
+		// shared unit rings for the tube resolution being built
+		const ofxBezierCapTemplates::TubeCap * tubeCap = nullptr;
+		std::vector <int> visibleLeaves;
+		std::vector <bool> dirtyChunks;
+
+		ofVboMesh mesh;
+		bool bMeshDirty = true;
+};
@@ -0,0 +1,233 @@
+//
+//  ofxBezierCurve.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierCurve.h"
+#include "ofxBezierRibbonMeshBuilder.h"
+#include "ofxBezierTubeMeshBuilder.h"
+
+ofxBezierCurve::ofxBezierCurve(){
+	colorFill = ofColor(188, 4, 62, 100);
+	colorStroke = ofColor(2, 189, 190, 100);
+}
+
+ofxBezierCurve::~ofxBezierCurve(){
+}
+
+void ofxBezierCurve::loadPoints(string filename){
+	ofFile jsonFile(filename);
+	if(jsonFile.exists()){
+		ofJson pntsJson;
+		jsonFile >> pntsJson;
+		loadPointsJson(pntsJson);
+	}else{
+		ofLogVerbose() << "ofxBezierCurve::loadPoints(): File does not exist.";
+	}
+}
+
+void ofxBezierCurve::loadPointsJson(const ofJson & pntsJson){
+	// we only read what we need, the document itself is not kept around
+	const ofJson & bezierJson = pntsJson["bezier"];
+	settings.loadMeshSettingsJson(bezierJson);
+
+	bfillBezier = bezierJson["fill"].get <bool>();
+	colorFill.set(bezierJson["colorFill"]["r"].get <int>(), bezierJson["colorFill"]["g"].get <int>(), bezierJson["colorFill"]["b"].get <int>(), bezierJson["colorFill"]["a"].get <int>());
+	colorStroke.set(bezierJson["colorStroke"]["r"].get <int>(), bezierJson["colorStroke"]["g"].get <int>(), bezierJson["colorStroke"]["b"].get <int>(), bezierJson["colorStroke"]["a"].get <int>());
+
+	curveVertices.clear();
+	for(const auto & vertexJson : bezierJson["vertices"]){
+		curveVertices.push_back(glm::vec2(vertexJson["x"].get <float>(), vertexJson["y"].get <float>()));
+	}
+	controlPoint1.clear();
+	for(const auto & cpJson : bezierJson["cp1"]){
+		controlPoint1.push_back(glm::vec2(cpJson["x"].get <float>(), cpJson["y"].get <float>()));
+	}
+	controlPoint2.clear();
+	for(const auto & cpJson : bezierJson["cp2"]){
+		controlPoint2.push_back(glm::vec2(cpJson["x"].get <float>(), cpJson["y"].get <float>()));
+	}
+	invalidate();
+}
+
+void ofxBezierCurve::savePoints(string filename){
+	ofJson pntsJson;
+	ofJson & bezierJson = pntsJson["bezier"];
+	bezierJson["fill"] = bfillBezier;
+	settings.saveMeshSettingsJson(bezierJson);
+
+	bezierJson["colorFill"]["r"] = colorFill.r;
+	bezierJson["colorFill"]["g"] = colorFill.g;
+	bezierJson["colorFill"]["b"] = colorFill.b;
+	bezierJson["colorFill"]["a"] = colorFill.a;
+
+	bezierJson["colorStroke"]["r"] = colorStroke.r;
+	bezierJson["colorStroke"]["g"] = colorStroke.g;
+	bezierJson["colorStroke"]["b"] = colorStroke.b;
+	bezierJson["colorStroke"]["a"] = colorStroke.a;
+
+	for(int i = 0; i < curveVertices.size(); i++){
+		bezierJson["vertices"][i]["x"] = curveVertices[i].x;
+		bezierJson["vertices"][i]["y"] = curveVertices[i].y;
+	}
+	for(int i = 0; i < controlPoint1.size(); i++){
+		bezierJson["cp1"][i]["x"] = controlPoint1[i].x;
+		bezierJson["cp1"][i]["y"] = controlPoint1[i].y;
+	}
+	for(int i = 0; i < controlPoint2.size(); i++){
+		bezierJson["cp2"][i]["x"] = controlPoint2[i].x;
+		bezierJson["cp2"][i]["y"] = controlPoint2[i].y;
+	}
+	ofSavePrettyJson(filename, pntsJson);
+}
+
+void ofxBezierCurve::setPoints(const std::vector <glm::vec2> & vertices, const std::vector <glm::vec2> & cp1, const std::vector <glm::vec2> & cp2){
+	curveVertices = vertices;
+	controlPoint1 = cp1;
+	controlPoint2 = cp2;
+	invalidate();
+}
+
+void ofxBezierCurve::updatePolyline(){
+	polyline.clear();
+	if(curveVertices.size() > 0){
+		polyline.addVertex(curveVertices[0].x, curveVertices[0].y);
+		for(int i = 1; i < curveVertices.size(); i++){
+			polyline.bezierTo(controlPoint1[i].x, controlPoint1[i].y, controlPoint2[i].x, controlPoint2[i].y, curveVertices[i].x, curveVertices[i].y);
+		}
+		if(settings.bIsClosed){
+			polyline.bezierTo(controlPoint1[0].x, controlPoint1[0].y, controlPoint2[0].x, controlPoint2[0].y, curveVertices[0].x, curveVertices[0].y);
+		}
+	}
+	polyline.setClosed(settings.bIsClosed);
+}
+
+void ofxBezierCurve::getSegments(std::vector <ofxBezierSegmentTree::Segment> & segments) const {
+	int count = curveVertices.size();
+	if(!settings.bIsClosed){
+		count--;
+	}
+	for(int i = 0; i < count; i++){
+		int next = (i + 1) % curveVertices.size();
+		ofxBezierSegmentTree::Segment segment;
+		segment.p0 = curveVertices[i];
+		segment.c1 = controlPoint1[next];
+		segment.c2 = controlPoint2[next];
+		segment.p1 = curveVertices[next];
+		segments.push_back(segment);
+	}
+}
+
+void ofxBezierCurve::update(){
+	if(!bNeedsRebuild){
+		return;
+	}
+	bNeedsRebuild = false;
+	bFillNeedsRebuild = true;
+	updatePolyline();
+
+	// meshes are sampled from the segments for exact tangents, unless the polyline has to be simplified first
+	std::vector <ofxBezierSegmentTree::Segment> segments;
+	if(settings.simplifyTolerance <= 0 && (settings.bUseRibbonMesh || settings.bUseTubeMesh)){
+		getSegments(segments);
+	}
+
+	// the builders only live for the duration of the build, so the curve does not keep their scratch buffers
+	if(settings.bUseRibbonMesh){
+		ofxBezierRibbonMeshBuilder ribbonMeshBuilder(settings);
+		if(segments.empty()){
+			ribbonMeshBuilder.generateRibbonMeshFromPolyline(polyline);
+		}else{
+			ribbonMeshBuilder.generateRibbonMeshFromSegments(segments);
+		}
+		ribbonMeshBuilder.moveRibbonMeshInto(ribbonMesh);
+	}else{
+		ribbonMesh.clear();
+	}
+	if(settings.bUseTubeMesh){
+		ofxBezierTubeMeshBuilder tubeMeshBuilder(settings);
+		if(segments.empty()){
+			tubeMeshBuilder.generateTubeMeshFromPolyline(polyline);
+		}else{
+			tubeMeshBuilder.generateTubeMeshFromSegments(segments);
+		}
+		tubeMeshBuilder.moveTubeMeshInto(tubeMesh);
+	}else{
+		tubeMesh.clear();
+	}
+}
+
+const ofPolyline & ofxBezierCurve::getPolyline(){
+	update();
+	return polyline;
+}
+
+const ofVboMesh & ofxBezierCurve::getRibbonMesh(){
+	update();
+	return ribbonMesh;
+}
+
+const ofVboMesh & ofxBezierCurve::getTubeMesh(){
+	update();
+	return tubeMesh;
+}
+
+void ofxBezierCurve::draw(){
+	update();
+	if(curveVertices.empty()){
+		return;
+	}
+	ofPushStyle();
+	if(bfillBezier && settings.bIsClosed){
+		// triangulated on the first draw after a change, not every frame
+		if(bFillNeedsRebuild){
+			ofTessellator tessellator;
+			tessellator.tessellateToMesh(polyline, OF_POLY_WINDING_ODD, fillMesh, true);
+			bFillNeedsRebuild = false;
+		}
+		ofFill();
+		ofSetColor(colorFill);
+		fillMesh.draw();
+	}
+	ofSetColor(colorStroke);
+	polyline.draw();
+	ofPopStyle();
+}
+
+void ofxBezierCurve::drawRibbon(){
+	getRibbonMesh().draw();
+}
+
+void ofxBezierCurve::drawTube(){
+	getTubeMesh().draw();
+}
+
+void ofxBezierCurve::setFromEditor(const std::vector <draggableVertex> & vertices, const std::vector <draggableVertex> & cp1, const std::vector <draggableVertex> & cp2,
+								   const ofxBezierMeshSettings & editorSettings, const ofPolyline & editorPolyline, const ofVboMesh & ribbon, const ofVboMesh & tube){
+	curveVertices.resize(vertices.size());
+	for(int i = 0; i < vertices.size(); i++){
+		curveVertices[i] = vertices[i].pos;
+	}
+	controlPoint1.resize(cp1.size());
+	for(int i = 0; i < cp1.size(); i++){
+		controlPoint1[i] = cp1[i].pos;
+	}
+	controlPoint2.resize(cp2.size());
+	for(int i = 0; i < cp2.size(); i++){
+		controlPoint2[i] = cp2[i].pos;
+	}
+	settings = editorSettings;
+	polyline = editorPolyline;
+	if(settings.bUseRibbonMesh){
+		ribbonMesh = ribbon;
+	}else{
+		ribbonMesh.clear();
+	}
+	if(settings.bUseTubeMesh){
+		tubeMesh = tube;
+	}else{
+		tubeMesh.clear();
+	}
+	bNeedsRebuild = false;
+	bFillNeedsRebuild = true;
+}
@@ -0,0 +1,102 @@
+//
+//  ofxBezierCurve.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxBezierMeshSettings.h"
+#include "draggableVertex.h"
+#include "ofxBezierSegmentTree.h"
+
+// A render-only bezier: geometry, tessellation and meshes, nothing else.
+// It has no UI, no debug state and no event listeners, so thousands of them can be
+// drawn cheaply. To edit one, attach it to an ofxBezierEditor with attachCurve().
+class ofxBezierCurve {
+	public:
+		ofxBezierCurve();
+		~ofxBezierCurve();
+
+		void loadPoints(string filename);
+		void loadPointsJson(const ofJson & pntsJson);
+		void savePoints(string filename);
+
+		// vertex i is reached through controlPoint1[i] and controlPoint2[i],
+		// the closing segment uses controlPoint1[0] and controlPoint2[0]
+		void setPoints(const std::vector <glm::vec2> & vertices, const std::vector <glm::vec2> & controlPoint1, const std::vector <glm::vec2> & controlPoint2);
+		const std::vector <glm::vec2> & getVertices() const {
+			return curveVertices;
+		}
+		const std::vector <glm::vec2> & getControlPoints1() const {
+			return controlPoint1;
+		}
+		const std::vector <glm::vec2> & getControlPoints2() const {
+			return controlPoint2;
+		}
+
+		// Changes are applied lazily, the meshes are rebuilt the next time they are needed
+		ofxBezierMeshSettings & getSettings(){
+			invalidate();
+			return settings;
+		}
+		const ofxBezierMeshSettings & getSettings() const {
+			return settings;
+		}
+		void invalidate(){
+			bNeedsRebuild = true;
+		}
+		void update();
+
+		void setFillBezier(bool value){
+			bfillBezier = value;
+		}
+		bool getFillBezier() const {
+			return bfillBezier;
+		}
+		void setColorFill(ofColor value){
+			colorFill = value;
+		}
+		ofColor getColorFill() const {
+			return colorFill;
+		}
+		void setColorStroke(ofColor value){
+			colorStroke = value;
+		}
+		ofColor getColorStroke() const {
+			return colorStroke;
+		}
+
+		const ofPolyline & getPolyline();
+		const ofVboMesh & getRibbonMesh();
+		const ofVboMesh & getTubeMesh();
+
+		void draw();
+		void drawRibbon();
+		void drawTube();
+
+		// Used by ofxBezierEditor to push an edited shape back without building it twice
+		void setFromEditor(const std::vector <draggableVertex> & vertices, const std::vector <draggableVertex> & cp1, const std::vector <draggableVertex> & cp2,
+						   const ofxBezierMeshSettings & editorSettings, const ofPolyline & polyline, const ofVboMesh & ribbon, const ofVboMesh & tube);
+
+	private:
+		void updatePolyline();
+		// the cubic segments in the editor's layout, segment i uses the control points of vertex i + 1
+		void getSegments(std::vector <ofxBezierSegmentTree::Segment> & segments) const;
+
+		std::vector <glm::vec2> curveVertices;
+		std::vector <glm::vec2> controlPoint1;
+		std::vector <glm::vec2> controlPoint2;
+
+		ofxBezierMeshSettings settings;
+		bool bfillBezier = false;
+		ofColor colorFill;
+		ofColor colorStroke;
+
+		ofPolyline polyline;
+		ofVboMesh ribbonMesh;
+		ofVboMesh tubeMesh;
+		ofVboMesh fillMesh;
+		bool bNeedsRebuild = true;
+		bool bFillNeedsRebuild = true;
+};
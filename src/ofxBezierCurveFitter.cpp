@@ -0,0 +1,299 @@
+//
+//  ofxBezierCurveFitter.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierCurveFitter.h"
+
+namespace {
+	// Bernstein basis of the cubic
+	inline float B0(float u){
+		float t = 1.0 - u;
+		return t * t * t;
+	}
+	inline float B1(float u){
+		float t = 1.0 - u;
+		return 3 * u * t * t;
+	}
+	inline float B2(float u){
+		float t = 1.0 - u;
+		return 3 * u * u * t;
+	}
+	inline float B3(float u){
+		return u * u * u;
+	}
+
+	glm::vec2 safeNormalize(const glm::vec2 & v){
+		float len = glm::length(v);
+		if(len < 1e-6){
+			return glm::vec2(0, 0);
+		}
+		return v / len;
+	}
+
+	// the direction from points[from] to the first sample at least reach away, walking by step and
+	// stopping at end. Neighbouring samples are too noisy to give a direction on their own.
+	glm::vec2 getTangent(const std::vector <glm::vec2> & points, int from, int end, int step, float reach){
+		int i = from;
+		while(i != end && glm::distance(points[i], points[from]) < reach){
+			i += step;
+		}
+		return safeNormalize(points[i] - points[from]);
+	}
+
+	// corners are looked for, and the tangents at them measured, over this many times the error tolerance
+	const float cornerReachMultiplier = 4.0;
+	const int maxDepth = 32;
+	const int maxIterations = 4;
+}
+
+void ofxBezierCurveFitter::FitCurve(const std::vector <glm::vec3> & samples, float errorTolerance, float cornerAngleDegrees, std::vector <Segment> & segments){
+	segments.clear();
+
+	// drop repeated samples, they break the chord length parameterisation
+	std::vector <glm::vec2> points;
+	points.reserve(samples.size());
+	for(const auto & sample : samples){
+		glm::vec2 p(sample.x, sample.y);
+		if(points.empty() || glm::distance(points.back(), p) > 0.01){
+			points.push_back(p);
+		}
+	}
+	if(points.size() < 2){
+		return;
+	}
+
+	// split the input at corners, each run between two corners is fitted on its own.
+	// Directions are measured over a distance rather than a number of samples so that
+	// sampling jitter in dense input does not read as a corner.
+	std::vector <int> corners;
+	corners.push_back(0);
+	float cornerCos = cos(ofDegToRad(cornerAngleDegrees));
+	float reach = std::max(errorTolerance * cornerReachMultiplier, 1.0f);
+	int back = 0;
+	int ahead = 0;
+	int lastCorner = 0;
+	// the angle test already passes up to about reach / 2 before the real corner, so the corner goes
+	// where the run of samples that pass it turns the most
+	int candidate = -1;
+	float candidateDot = 1;
+	for(int i = 1; i < (int)points.size() - 1; i++){
+		while(back + 1 < i && glm::distance(points[back + 1], points[i]) >= reach){
+			back++;
+		}
+		ahead = std::max(ahead, i);
+		while(ahead < (int)points.size() - 1 && glm::distance(points[ahead], points[i]) < reach){
+			ahead++;
+		}
+		float turn = 1;
+		if(glm::distance(points[back], points[i]) >= reach && glm::distance(points[ahead], points[i]) >= reach){
+			glm::vec2 in = safeNormalize(points[i] - points[back]);
+			glm::vec2 out = safeNormalize(points[ahead] - points[i]);
+			turn = glm::dot(in, out);
+		}
+		if(turn < cornerCos && (candidate >= 0 || glm::distance(points[lastCorner], points[i]) >= reach)){
+			if(turn < candidateDot){
+				candidate = i;
+				candidateDot = turn;
+			}
+		}else if(candidate >= 0){
+			corners.push_back(candidate);
+			lastCorner = candidate;
+			candidate = -1;
+			candidateDot = 1;
+		}
+	}
+	if(candidate >= 0){
+		corners.push_back(candidate);
+	}
+	corners.push_back(points.size() - 1);
+
+	for(int c = 0; c < corners.size() - 1; c++){
+		int first = corners[c];
+		int last = corners[c + 1];
+		// measured over the same distance as the corners, so they agree on the direction either side
+		glm::vec2 tangent1 = getTangent(points, first, last, 1, reach);
+		glm::vec2 tangent2 = getTangent(points, last, first, -1, reach);
+		FitCubic(points, first, last, tangent1, tangent2, errorTolerance, segments, 0);
+	}
+}
+
+void ofxBezierCurveFitter::FitCurve(const std::vector <glm::vec3> & samples, float errorTolerance, float cornerAngleDegrees,
+									std::vector <glm::vec2> & vertices, std::vector <glm::vec2> & controlPoint1, std::vector <glm::vec2> & controlPoint2){
+	std::vector <Segment> segments;
+	FitCurve(samples, errorTolerance, cornerAngleDegrees, segments);
+
+	vertices.clear();
+	controlPoint1.clear();
+	controlPoint2.clear();
+	if(segments.empty()){
+		return;
+	}
+
+	vertices.push_back(segments.front().p0);
+	// slot 0 is the closing segment, a straight line from the last vertex back to the first
+	glm::vec2 first = segments.front().p0;
+	glm::vec2 last = segments.back().p1;
+	controlPoint1.push_back(glm::mix(last, first, 1.0f / 3.0f));
+	controlPoint2.push_back(glm::mix(last, first, 2.0f / 3.0f));
+
+	for(const auto & segment : segments){
+		vertices.push_back(segment.p1);
+		controlPoint1.push_back(segment.c1);
+		controlPoint2.push_back(segment.c2);
+	}
+}
+
+void ofxBezierCurveFitter::FitCubic(const std::vector <glm::vec2> & points, int first, int last, glm::vec2 tangent1, glm::vec2 tangent2, float error, std::vector <Segment> & segments, int depth){
+	int nPts = last - first + 1;
+
+	// two points, use the heuristic from the paper
+	if(nPts == 2){
+		float dist = glm::distance(points[first], points[last]) / 3.0;
+		Segment bezier;
+		bezier.p0 = points[first];
+		bezier.p1 = points[last];
+		bezier.c1 = bezier.p0 + tangent1 * dist;
+		bezier.c2 = bezier.p1 + tangent2 * dist;
+		segments.push_back(bezier);
+		return;
+	}
+
+	std::vector <float> u;
+	ChordLengthParameterize(points, first, last, u);
+	Segment bezier = GenerateBezier(points, first, last, u, tangent1, tangent2);
+
+	int splitPoint;
+	float maxError = ComputeMaxError(bezier, points, first, last, u, splitPoint);
+	if(maxError < error * error){
+		segments.push_back(bezier);
+		return;
+	}
+
+	// if we are close, a few newton steps on the parameters usually get us there
+	float iterationError = error * error * 4.0;
+	if(maxError < iterationError){
+		for(int i = 0; i < maxIterations; i++){
+			Reparameterize(bezier, points, first, last, u);
+			bezier = GenerateBezier(points, first, last, u, tangent1, tangent2);
+			maxError = ComputeMaxError(bezier, points, first, last, u, splitPoint);
+			if(maxError < error * error){
+				segments.push_back(bezier);
+				return;
+			}
+		}
+	}
+
+	if(depth >= maxDepth){
+		segments.push_back(bezier);
+		return;
+	}
+
+	// fitting failed, split at the worst point and fit both halves
+	glm::vec2 centerTangent = safeNormalize(points[splitPoint - 1] - points[splitPoint + 1]);
+	if(glm::length(centerTangent) == 0){
+		centerTangent = safeNormalize(points[splitPoint - 1] - points[splitPoint]);
+	}
+	FitCubic(points, first, splitPoint, tangent1, centerTangent, error, segments, depth + 1);
+	FitCubic(points, splitPoint, last, -centerTangent, tangent2, error, segments, depth + 1);
+}
+
+ofxBezierCurveFitter::Segment ofxBezierCurveFitter::GenerateBezier(const std::vector <glm::vec2> & points, int first, int last, const std::vector <float> & u, glm::vec2 tangent1, glm::vec2 tangent2){
+	int nPts = last - first + 1;
+	const glm::vec2 & p0 = points[first];
+	const glm::vec2 & p3 = points[last];
+
+	// build the 2x2 least squares system for the two tangent lengths
+	float C[2][2] = { { 0, 0 }, { 0, 0 } };
+	float X[2] = { 0, 0 };
+	for(int i = 0; i < nPts; i++){
+		glm::vec2 a1 = tangent1 * B1(u[i]);
+		glm::vec2 a2 = tangent2 * B2(u[i]);
+		C[0][0] += glm::dot(a1, a1);
+		C[0][1] += glm::dot(a1, a2);
+		C[1][1] += glm::dot(a2, a2);
+
+		glm::vec2 tmp = points[first + i] - (p0 * B0(u[i]) + p0 * B1(u[i]) + p3 * B2(u[i]) + p3 * B3(u[i]));
+		X[0] += glm::dot(a1, tmp);
+		X[1] += glm::dot(a2, tmp);
+	}
+	C[1][0] = C[0][1];
+
+	float detC0C1 = C[0][0] * C[1][1] - C[1][0] * C[0][1];
+	float detC0X = C[0][0] * X[1] - C[1][0] * X[0];
+	float detXC1 = X[0] * C[1][1] - X[1] * C[0][1];
+
+	float alphaL = (detC0C1 == 0) ? 0.0 : detXC1 / detC0C1;
+	float alphaR = (detC0C1 == 0) ? 0.0 : detC0X / detC0C1;
+
+	Segment bezier;
+	bezier.p0 = p0;
+	bezier.p1 = p3;
+
+	// degenerate or negative lengths, fall back to the heuristic
+	float segLength = glm::distance(p0, p3);
+	float epsilon = 1.0e-6 * segLength;
+	if(alphaL < epsilon || alphaR < epsilon){
+		float dist = segLength / 3.0;
+		bezier.c1 = p0 + tangent1 * dist;
+		bezier.c2 = p3 + tangent2 * dist;
+		return bezier;
+	}
+
+	bezier.c1 = p0 + tangent1 * alphaL;
+	bezier.c2 = p3 + tangent2 * alphaR;
+	return bezier;
+}
+
+void ofxBezierCurveFitter::ChordLengthParameterize(const std::vector <glm::vec2> & points, int first, int last, std::vector <float> & u){
+	u.assign(last - first + 1, 0);
+	for(int i = first + 1; i <= last; i++){
+		u[i - first] = u[i - first - 1] + glm::distance(points[i], points[i - 1]);
+	}
+	float total = u[last - first];
+	if(total > 0){
+		for(auto & value : u){
+			value /= total;
+		}
+	}
+}
+
+void ofxBezierCurveFitter::Reparameterize(const Segment & bezier, const std::vector <glm::vec2> & points, int first, int last, std::vector <float> & u){
+	// first and second derivative control points
+	glm::vec2 d1[3] = { (bezier.c1 - bezier.p0) * 3.0f, (bezier.c2 - bezier.c1) * 3.0f, (bezier.p1 - bezier.c2) * 3.0f };
+	glm::vec2 d2[2] = { (d1[1] - d1[0]) * 2.0f, (d1[2] - d1[1]) * 2.0f };
+
+	for(int i = first; i <= last; i++){
+		float t = u[i - first];
+		float mt = 1.0 - t;
+		glm::vec2 q = Evaluate(bezier, t);
+		glm::vec2 q1 = d1[0] * mt * mt + d1[1] * 2.0f * mt * t + d1[2] * t * t;
+		glm::vec2 q2 = d2[0] * mt + d2[1] * t;
+
+		// one newton-raphson step on (Q(t) - P) . Q'(t) = 0
+		glm::vec2 diff = q - points[i];
+		float numerator = glm::dot(diff, q1);
+		float denominator = glm::dot(q1, q1) + glm::dot(diff, q2);
+		if(denominator != 0){
+			u[i - first] = ofClamp(t - numerator / denominator, 0, 1);
+		}
+	}
+}
+
+float ofxBezierCurveFitter::ComputeMaxError(const Segment & bezier, const std::vector <glm::vec2> & points, int first, int last, const std::vector <float> & u, int & splitPoint){
+	// squared distances, the split point is never an end point
+	splitPoint = (last - first + 1) / 2 + first;
+	float maxDist = 0;
+	for(int i = first + 1; i < last; i++){
+		float dist = glm::distance2(Evaluate(bezier, u[i - first]), points[i]);
+		if(dist >= maxDist){
+			maxDist = dist;
+			splitPoint = i;
+		}
+	}
+	return maxDist;
+}
+
+glm::vec2 ofxBezierCurveFitter::Evaluate(const Segment & bezier, float t){
+	return bezier.p0 * B0(t) + bezier.c1 * B1(t) + bezier.c2 * B2(t) + bezier.p1 * B3(t);
+}
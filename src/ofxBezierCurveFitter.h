@@ -0,0 +1,42 @@
+//
+//  ofxBezierCurveFitter.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+// Least squares cubic bezier fitting (Philip J. Schneider, "An Algorithm for Automatically
+// Fitting Digitized Curves", Graphics Gems 1990), with corner detection so sharp turns in
+// the input stay sharp instead of being smoothed over.
+class ofxBezierCurveFitter {
+	public:
+		struct Segment {
+			glm::vec2 p0;
+			glm::vec2 c1;
+			glm::vec2 c2;
+			glm::vec2 p1;
+		};
+
+		// Fits the samples with as few cubic segments as possible so that no sample is further than
+		// errorTolerance from the curve. Turns sharper than cornerAngleDegrees split the fit.
+		static void FitCurve(const std::vector <glm::vec3> & samples, float errorTolerance, float cornerAngleDegrees, std::vector <Segment> & segments);
+
+		// Same, written in the editor's layout: vertex i is reached through controlPoint1[i] and controlPoint2[i],
+		// controlPoint1[0] and controlPoint2[0] hold a straight closing segment.
+		static void FitCurve(const std::vector <glm::vec3> & samples, float errorTolerance, float cornerAngleDegrees,
+							 std::vector <glm::vec2> & vertices, std::vector <glm::vec2> & controlPoint1, std::vector <glm::vec2> & controlPoint2);
+
+	private:
+		ofxBezierCurveFitter(){
+		}                 // Private constructor to prevent instantiation
+
+		static void FitCubic(const std::vector <glm::vec2> & points, int first, int last, glm::vec2 tangent1, glm::vec2 tangent2, float error, std::vector <Segment> & segments, int depth);
+		static Segment GenerateBezier(const std::vector <glm::vec2> & points, int first, int last, const std::vector <float> & u, glm::vec2 tangent1, glm::vec2 tangent2);
+		static void ChordLengthParameterize(const std::vector <glm::vec2> & points, int first, int last, std::vector <float> & u);
+		static void Reparameterize(const Segment & bezier, const std::vector <glm::vec2> & points, int first, int last, std::vector <float> & u);
+		static float ComputeMaxError(const Segment & bezier, const std::vector <glm::vec2> & points, int first, int last, const std::vector <float> & u, int & splitPoint);
+
+		static glm::vec2 Evaluate(const Segment & bezier, float t);
+};
@@ -8,10 +8,13 @@
 #include "ofxBezierDraw.h"
 
 ofxBezierDraw::ofxBezierDraw(ofxBezierEditorSettings & settings,
+							 const ofxBezierProfiler & profiler,
+							 const ofxBezierSegmentTree & segmentTree,
+							 const ofPolyline & polyline,
 							 std::vector <draggableVertex> & curveVertices,
 							 std::vector <draggableVertex> & controlPoint1,
 							 std::vector <draggableVertex> & controlPoint2)
-	: settings(settings), curveVertices(curveVertices), controlPoint1(controlPoint1), controlPoint2(controlPoint2){
+	: settings(settings), profiler(profiler), segmentTree(segmentTree), polyline(polyline), curveVertices(curveVertices), controlPoint1(controlPoint1), controlPoint2(controlPoint2){
 
 
 }
@@ -23,21 +26,9 @@ void ofxBezierDraw::draw(){
 
 	if(curveVertices.size() > 0){
 		ofPushMatrix();
+		applyTransform();
 		if(settings.bfillBezier && settings.bIsClosed){
-			ofFill();
-			ofSetColor(settings.colorFill);
-			ofBeginShape();
-			for(int i = 0; i < curveVertices.size(); i++){
-				if(i == 0){
-					ofVertex(curveVertices.at(0).pos.x, curveVertices.at(0).pos.y); // we need to duplicate 0 for the curve to start at point 0
-				}else{
-					ofBezierVertex(controlPoint1.at(i).pos.x, controlPoint1.at(i).pos.y, controlPoint2.at(i).pos.x, controlPoint2.at(i).pos.y, curveVertices.at(i).pos.x, curveVertices.at(i).pos.y);
-				}
-			}
-
-			ofBezierVertex(controlPoint1.at(0).pos.x, controlPoint1.at(0).pos.y, controlPoint2.at(0).pos.x, controlPoint2.at(0).pos.y, curveVertices.at(0).pos.x, curveVertices.at(0).pos.y);
-
-			ofEndShape(settings.bIsClosed);
+			drawFill();
 		}
 
 
@@ -63,6 +54,82 @@ void ofxBezierDraw::draw(){
 
 }
 
+//--------------------------------------------------------------
+void ofxBezierDraw::draw(const ofRectangle & viewport){
+	// the tree is in curve coordinates, so the viewport goes the other way instead of the curve
+	ofRectangle curveViewport = settings.toCurveCoordinates(viewport);
+	if(curveVertices.size() < 2 || !segmentTree.getBounds().intersects(curveViewport)){
+		return;
+	}
+	ofPushStyle();
+	ofPushMatrix();
+	applyTransform();
+	// the fill is one polygon, it can't be cut into chunks
+	if(settings.bfillBezier && settings.bIsClosed){
+		drawFill();
+	}
+
+	if(bStrokeDirty){
+		strokeVbo.setVertexData(polyline.getVertices().data(), polyline.size(), GL_DYNAMIC_DRAW);
+		bStrokeDirty = false;
+	}
+
+	ofSetColor(settings.colorStroke);
+	ofNoFill();
+	visibleLeaves.clear();
+	segmentTree.queryLeaves(curveViewport, visibleLeaves);
+
+	// leaves come in segment order, neighbouring ones are drawn with a single call
+	const auto & nodes = segmentTree.getNodes();
+	const auto & segments = segmentTree.getSegments();
+	int runFirst = -1;
+	int runLast = -1;
+	for(int leaf : visibleLeaves){
+		const ofxBezierSegmentTree::Node & node = nodes[leaf];
+		int first = segments[node.first].polylineFirst;
+		int last = segments[node.first + node.count - 1].polylineLast;
+		if(runFirst >= 0 && first > runLast){
+			strokeVbo.draw(GL_LINE_STRIP, runFirst, runLast - runFirst + 1);
+			runFirst = -1;
+		}
+		if(runFirst < 0){
+			runFirst = first;
+		}
+		runLast = last;
+	}
+	if(runFirst >= 0){
+		strokeVbo.draw(GL_LINE_STRIP, runFirst, runLast - runFirst + 1);
+	}
+	ofPopMatrix();
+	ofPopStyle();
+}
+
+void ofxBezierDraw::applyTransform(){
+	if(settings.hasTransform()){
+		ofMultMatrix(settings.getTransformMatrix());
+	}
+}
+
+void ofxBezierDraw::drawFill(){
+	ofFill();
+	ofSetColor(settings.colorFill);
+	fillMesh.draw();
+}
+
+void ofxBezierDraw::updateFill(const ofPolyline & polyline){
+	// same winding rule as ofBeginShape/ofEndShape so the result looks the same
+	fillTessellator.tessellateToMesh(polyline, OF_POLY_WINDING_ODD, fillMesh, true);
+}
+
+void ofxBezierDraw::clearFill(){
+	fillMesh.clear();
+}
+
+void ofxBezierDraw::markStrokeDirty(){
+	bStrokeDirty = true;
+	strokeRevision++;
+}
+
 //--------------------------------------------------------------
 void ofxBezierDraw::drawOutline(){
 
@@ -87,98 +154,184 @@ void ofxBezierDraw::drawOutline(){
 
 }
 
-void ofxBezierDraw::drawWithNormals(const ofPolyline & polyline){
-
-	ofPushStyle(); // Push the current style settings
-	for(int i = 0; i < polyline.size(); i++){
-		const ofPoint & cur = polyline[i];
-		const ofPoint & normal = polyline.getNormalAtIndex(i);
-
-		ofPushMatrix();
-		ofTranslate(cur.x, cur.y, 0);
-
-		ofSetColor(255, 0, 255); // Set color before drawing lines
-
-		ofDrawLine(0, 0, normal.x * 20, normal.y * 20); // Draw normals
+void ofxBezierDraw::drawNormals(){
+	if(normalMeshRevision != strokeRevision){
+		updateNormalMesh();
+	}
+	ofPushStyle();
+	ofSetColor(255, 0, 255);
+	normalMesh.draw();
+	ofPopStyle();
+}
 
-		ofPopMatrix();
+void ofxBezierDraw::updateNormalMesh(){
+	normalMeshRevision = strokeRevision;
+	normalMesh.clear();
+	normalMesh.setMode(OF_PRIMITIVE_LINES);
+	const auto & strokeVertices = polyline.getVertices();
+	int count = strokeVertices.size();
+	if(count < 2){
+		return;
+	}
+	const float normalLength = 20;
+	// closed strokes repeat the first vertex at the end, their neighbours wrap past it
+	auto direction = [](const glm::vec3 & from, const glm::vec3 & to){
+		glm::vec3 d = to - from;
+		return glm::length2(d) > 0 ? glm::normalize(d) : d;
+	};
+	normalMesh.getVertices().reserve(count * 2);
+	for(int i = 0; i < count; i++){
+		const glm::vec3 & cur = strokeVertices[i];
+		const glm::vec3 & prev = (i > 0) ? strokeVertices[i - 1] : (settings.bIsClosed && count > 2 ? strokeVertices[count - 2] : cur);
+		const glm::vec3 & next = (i < count - 1) ? strokeVertices[i + 1] : (settings.bIsClosed && count > 2 ? strokeVertices[1] : cur);
+		glm::vec3 tangent = direction(prev, cur) + direction(cur, next);
+		if(glm::length2(tangent) == 0){
+			continue;
+		}
+		tangent = glm::normalize(tangent);
+		normalMesh.addVertex(cur);
+		normalMesh.addVertex(cur + glm::vec3(tangent.y, -tangent.x, 0) * normalLength);
 	}
 }
 //--------------------------------------------------------------
-void ofxBezierDraw::drawHelp(){
-	ofSetBackgroundColor(200);
-	if(curveVertices.size() > 0){
-		draw();
+void ofxBezierDraw::drawHandles(){
+	if(unitCircle.empty()){
+		for(int i = 0; i <= handleCircleResolution; i++){
+			float angle = TWO_PI * i / handleCircleResolution;
+			unitCircle.push_back(glm::vec2(cos(angle), sin(angle)));
+		}
+	}
 
-		drawWithNormals(normalLine);
-		ofPushMatrix();
-		ofSetLineWidth(1);
-		ofNoFill();
-		ofSetColor(0, 0, 0, 40);
-		for(int i = 0; i < curveVertices.size(); i++){
-			ofDrawLine(curveVertices.at(i).pos.x, curveVertices.at(i).pos.y, controlPoint2.at(i).pos.x, controlPoint2.at(i).pos.y);
+	// the lines from the vertices to their control points, in the same batch as the outlines
+	handleLineMesh.clear();
+	handleLineMesh.setMode(OF_PRIMITIVE_LINES);
+	handleFillMesh.clear();
+	handleFillMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+	ofFloatColor controlLineColor(0, 0, 0, 40 / 255.0);
+	auto addControlLine = [&](const glm::vec2 & from, const glm::vec2 & to){
+		handleLineMesh.addVertex(glm::vec3(from, 0));
+		handleLineMesh.addVertex(glm::vec3(to, 0));
+		handleLineMesh.addColor(controlLineColor);
+		handleLineMesh.addColor(controlLineColor);
+	};
+	for(int i = 0; i < curveVertices.size(); i++){
+		addControlLine(curveVertices[i].pos, controlPoint2[i].pos);
+	}
+	for(int i = 1; i < curveVertices.size(); i++){
+		addControlLine(curveVertices[i - 1].pos, controlPoint1[i].pos);
+	}
+	addControlLine(curveVertices.back().pos, controlPoint1[0].pos);
+
+	// same states and colours as one circle per handle had, hover and drag fill the marker
+	for(const auto & vertex : curveVertices){
+		ofColor color = vertex.bBeingDragged ? settings.vertexDraggedColour : vertex.bOver ? settings.vertexHoverColor : settings.vertexColour;
+		addHandleMarker(vertex.pos, settings.radiusVertex, color, vertex.bOver || vertex.bBeingDragged);
+		if(vertex.bBeingSelected){
+			addHandleMarker(vertex.pos, settings.radiusVertex, settings.vertexSelectedColour, true);
+			addHandleMarker(vertex.pos, 2 * settings.radiusVertex, settings.vertexSelectedColour, false);
 		}
-		for(int i = 1; i < curveVertices.size(); i++){
-			ofDrawLine(curveVertices.at(i - 1).pos.x, curveVertices.at(i - 1).pos.y, controlPoint1.at(i).pos.x, controlPoint1.at(i).pos.y);
+	}
+	for(const auto * controlPoints : { &controlPoint1, &controlPoint2 }){
+		for(const auto & controlPoint : *controlPoints){
+			ofColor color = controlPoint.bBeingDragged ? settings.ctrPtDraggedColour : controlPoint.bOver ? settings.ctrPtHoverColor : settings.ctrPtColour;
+			addHandleMarker(controlPoint.pos, settings.radiusControlPoints, color, controlPoint.bOver || controlPoint.bBeingDragged);
 		}
-		ofDrawLine(curveVertices.at(curveVertices.size() - 1).pos.x, curveVertices.at(curveVertices.size() - 1).pos.y, controlPoint1.at(0).pos.x, controlPoint1.at(0).pos.y); // =
+	}
 
+	ofPushStyle();
+	ofSetColor(255);
+	handleFillMesh.draw();
+	handleLineMesh.draw();
+	ofPopStyle();
+}
 
-		for(int i = 0; i < curveVertices.size(); i++){
-			ofSetColor(settings.vertexColour);
-			ofNoFill();
-			if(curveVertices.at(i).bOver == true){
-				ofSetColor(settings.vertexHoverColor);
-				ofFill();
+void ofxBezierDraw::addHandleMarker(const glm::vec2 & center, float radius, const ofFloatColor & color, bool filled){
+	for(int i = 0; i < handleCircleResolution; i++){
+		glm::vec3 a(center + unitCircle[i] * radius, 0);
+		glm::vec3 b(center + unitCircle[i + 1] * radius, 0);
+		if(filled){
+			handleFillMesh.addVertex(glm::vec3(center, 0));
+			handleFillMesh.addVertex(a);
+			handleFillMesh.addVertex(b);
+			for(int k = 0; k < 3; k++){
+				handleFillMesh.addColor(color);
 			}
-			if(curveVertices.at(i).bBeingDragged == true){
-				ofSetColor(settings.vertexDraggedColour);
-				ofFill();
-			}
-			ofDrawCircle(curveVertices.at(i).pos.x, curveVertices.at(i).pos.y, settings.radiusVertex);
-			if(curveVertices.at(i).bBeingSelected == true){
-				ofSetColor(settings.vertexSelectedColour);
-				ofFill();
-				ofDrawCircle(curveVertices.at(i).pos.x, curveVertices.at(i).pos.y, settings.radiusVertex);
-				ofNoFill();
-				ofDrawCircle(curveVertices.at(i).pos.x, curveVertices.at(i).pos.y, 2 * settings.radiusVertex);
-			}
-			ofSetColor(settings.vertexLabelColour);
-			ofDrawBitmapString("v_" + ofToString(i), curveVertices.at(i).pos.x + 3, curveVertices.at(i).pos.y + 3);
+		}else{
+			handleLineMesh.addVertex(a);
+			handleLineMesh.addVertex(b);
+			handleLineMesh.addColor(color);
+			handleLineMesh.addColor(color);
 		}
+	}
+}
 
-
-		for(int i = 0; i < controlPoint1.size(); i++){
-			ofSetColor(settings.ctrPtColour);
-			ofNoFill();
-			if(controlPoint1.at(i).bOver == true){
-				ofSetColor(settings.ctrPtHoverColor);
-				ofFill();
-			}
-			if(controlPoint1.at(i).bBeingDragged == true){
-				ofSetColor(settings.ctrPtDraggedColour);
-				ofFill();
+void ofxBezierDraw::drawHandleLabels(){
+	int handleCount = curveVertices.size() + controlPoint1.size() + controlPoint2.size();
+	bool bFlipped = ofGetCurrentRenderer()->isVFlipped();
+	// the glyphs only change with the number of handles, every frame they are just moved to their handles
+	if(handleCount != labelHandleCount || bFlipped != bLabelsFlipped || labelVertexColour != settings.vertexLabelColour || labelControlColour != settings.ctrPtLabelColour){
+		labelHandleCount = handleCount;
+		bLabelsFlipped = bFlipped;
+		labelVertexColour = settings.vertexLabelColour;
+		labelControlColour = settings.ctrPtLabelColour;
+		labelGlyphVertices.clear();
+		labelGlyphOwners.clear();
+		labelMesh.clear();
+		labelMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+		auto addLabel = [&](const std::string & text, int owner, const ofFloatColor & color){
+			const ofMesh & glyphs = labelFont.getMesh(text, 0, 0, OF_BITMAPMODE_MODEL, bFlipped);
+			for(int k = 0; k < glyphs.getNumVertices(); k++){
+				labelGlyphVertices.push_back(glyphs.getVertices()[k]);
+				labelGlyphOwners.push_back(owner);
+				labelMesh.addVertex(glyphs.getVertices()[k]);
+				labelMesh.addTexCoord(glyphs.getTexCoords()[k]);
+				labelMesh.addColor(color);
 			}
-			ofDrawCircle(controlPoint1.at(i).pos.x, controlPoint1.at(i).pos.y, settings.radiusControlPoints);
-			ofSetColor(settings.ctrPtLabelColour);
-			ofDrawBitmapString("cp1_" + ofToString(i), controlPoint1.at(i).pos.x + 3, controlPoint1.at(i).pos.y + 3);
+		};
+		int owner = 0;
+		for(int i = 0; i < curveVertices.size(); i++){
+			addLabel("v_" + ofToString(i), owner++, settings.vertexLabelColour);
+		}
+		for(int i = 0; i < controlPoint1.size(); i++){
+			addLabel("cp1_" + ofToString(i), owner++, settings.ctrPtLabelColour);
 		}
-
 		for(int i = 0; i < controlPoint2.size(); i++){
-			ofSetColor(settings.ctrPtColour);
-			ofNoFill();
-			if(controlPoint2.at(i).bOver == true){
-				ofSetColor(settings.ctrPtHoverColor);
-				ofFill();
-			}
-			if(controlPoint2.at(i).bBeingDragged == true){
-				ofSetColor(settings.ctrPtDraggedColour);
-				ofFill();
-			}
-			ofDrawCircle(controlPoint2.at(i).pos.x, controlPoint2.at(i).pos.y, settings.radiusControlPoints);
-			ofSetColor(settings.ctrPtLabelColour);
-			ofDrawBitmapString("cp2_" + ofToString(i), controlPoint2.at(i).pos.x + 3, controlPoint2.at(i).pos.y + 3);
+			addLabel("cp2_" + ofToString(i), owner++, settings.ctrPtLabelColour);
+		}
+	}
+
+	labelAnchors.resize(handleCount);
+	int owner = 0;
+	for(const auto * handles : { &curveVertices, &controlPoint1, &controlPoint2 }){
+		for(const auto & handle : *handles){
+			labelAnchors[owner++] = glm::vec3(settings.fromCurveCoordinates(handle.pos) + glm::vec2(3, 3), 0);
 		}
+	}
+	auto & vertices = labelMesh.getVertices();
+	for(int k = 0; k < vertices.size(); k++){
+		vertices[k] = labelAnchors[labelGlyphOwners[k]] + labelGlyphVertices[k];
+	}
+
+	ofPushStyle();
+	ofEnableAlphaBlending();
+	ofSetColor(255);
+	labelFont.getTexture().bind();
+	labelMesh.draw();
+	labelFont.getTexture().unbind();
+	ofPopStyle();
+}
+
+//--------------------------------------------------------------
+void ofxBezierDraw::drawHelp(){
+	ofSetBackgroundColor(200);
+	if(curveVertices.size() > 0){
+		draw();
+
+		ofPushMatrix();
+		applyTransform();
+		drawNormals();
+		ofSetLineWidth(1);
+		drawHandles();
 
 		int range = settings.currentPointToMove / curveVertices.size();
 		int mod = settings.currentPointToMove % curveVertices.size();
@@ -212,6 +365,9 @@ void ofxBezierDraw::drawHelp(){
 			ofDrawRectangle(settings.boundingBox);
 		}
 		ofPopMatrix();
+
+		// labels stay the size of the bitmap font, so they are placed on screen rather than under the transform
+		drawHandleLabels();
 	}
 
 	ofSetColor(0, 0, 0);
@@ -220,7 +376,7 @@ void ofxBezierDraw::drawHelp(){
 	ofDrawBitmapString("backspace to delete last point added", 20, 60);
 	ofDrawBitmapString("drag mouse to move vertex and control points", 20, 80);
 	ofDrawBitmapString("mouse right button to select two vertex", 20, 100);
-	ofDrawBitmapString("mouse right button to add a new vertex between the two selected vertex", 20, 120);
+	ofDrawBitmapString("mouse right button on the curve, or between the two selected vertex, to add a new vertex", 20, 120);
 	ofDrawBitmapString("supr to delete last vertex added", 20, 140);
 	ofDrawBitmapString("currentPointToMove [n++|m--]: " + ofToString(settings.currentPointToMove) + "\n fine tune with arrows", 20, 160);
 	ofDrawBitmapString("[l] load stored bezier", 20, 200);
@@ -228,10 +384,36 @@ void ofxBezierDraw::drawHelp(){
 	ofDrawBitmapString("[f] toogle fill: " + ofToString(settings.bfillBezier), 20, 240);
 	ofDrawBitmapString("[b] show/hide bounding box: " + ofToString(settings.bshowBoundingBox), 20, 260);
 	ofDrawBitmapString("drag bounding box to move all the bezier", 20, 280);
-	ofDrawBitmapString("COLORS:\nfill " + ofToString((float)settings.colorFill.r) + "(r) " + ofToString((float)settings.colorFill.g) + "(g) " + ofToString((float)settings.colorFill.b) + "(b)" + "\nstroke " + ofToString((float)settings.colorStroke.r) + "(r) " + ofToString((float)settings.colorStroke.g) + "(g) " + ofToString((float)settings.colorStroke.b) + "(b)", 20, 300);
+	ofDrawBitmapString("[p] show/hide rebuild profiler: " + ofToString(settings.bShowProfilerOverlay), 20, 300);
+	ofDrawBitmapString("COLORS:\nfill " + ofToString((float)settings.colorFill.r) + "(r) " + ofToString((float)settings.colorFill.g) + "(g) " + ofToString((float)settings.colorFill.b) + "(b)" + "\nstroke " + ofToString((float)settings.colorStroke.r) + "(r) " + ofToString((float)settings.colorStroke.g) + "(g) " + ofToString((float)settings.colorStroke.b) + "(b)", 20, 320);
 
+	if(settings.bShowProfilerOverlay){
+		drawProfilerOverlay(ofGetWidth() - 320, 20);
+	}
 }
 
-void ofxBezierDraw::updateNormalLine(ofPolyline line){
-	normalLine = line;
+//--------------------------------------------------------------
+void ofxBezierDraw::drawProfilerOverlay(float x, float y){
+#if OFX_BEZIER_PROFILING
+	const ofxBezierProfiler::Rebuild & rebuild = profiler.getLastRebuild();
+
+	std::string text = "LAST REBUILD (" + rebuild.trigger + ", frame " + ofToString(rebuild.frame) + ")\n";
+	text += "total: " + ofToString(rebuild.totalMicros / 1000.0, 3) + " ms\n";
+	for(int i = 0; i < ofxBezierProfiler::STAGE_COUNT; i++){
+		if(rebuild.stageRan[i]){
+			text += "  " + ofxBezierProfiler::getStageName((ofxBezierProfiler::Stage)i) + ": " + ofToString(rebuild.stageMicros[i] / 1000.0, 3) + " ms\n";
+		}
+	}
+	text += "vertices: " + ofToString(rebuild.curveVertices) + "  polyline: " + ofToString(rebuild.polylineVertices) + "\n";
+	text += "ribbon verts: " + ofToString(rebuild.ribbonVertices) + "  tube verts: " + ofToString(rebuild.tubeVertices) + "\n";
+	text += "tube rings: " + ofToString(rebuild.tubeRings) + "  buffer growths: " + ofToString(rebuild.bufferGrowths) + "\n";
+	text += "simplify reduction: " + ofToString(rebuild.simplifyReductionRatio, 2) + "x  changed segments: " + ofToString(rebuild.changedSegments) + "\n";
+	text += "rebuilt chunks: " + ofToString(rebuild.rebuiltChunks) + "  merged input events: " + ofToString(rebuild.mergedInputEvents) + "\n";
+	text += "rebuilds: " + ofToString(profiler.getRebuildCount());
+
+	ofDrawBitmapStringHighlight(text, x, y, ofColor(0, 0, 0, 180), ofColor(255));
+#else
+	ofDrawBitmapStringHighlight("profiling compiled out (OFX_BEZIER_PROFILING 0)", x, y);
+#endif
 }
+
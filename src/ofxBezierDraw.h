@@ -11,10 +11,15 @@
 #include "ofxBezierEditorSettings.h"
 #include "draggableVertex.h"
 #include "ofxBezierEvents.h"
+#include "ofxBezierProfiler.h"
+#include "ofxBezierSegmentTree.h"
 
 class ofxBezierDraw {
 	public:
 		ofxBezierDraw(ofxBezierEditorSettings & settings,
+					  const ofxBezierProfiler & profiler,
+					  const ofxBezierSegmentTree & segmentTree,
+					  const ofPolyline & polyline,
 					  std::vector <draggableVertex> & curveVertices,
 					  std::vector <draggableVertex> & controlPoint1,
 					  std::vector <draggableVertex> & controlPoint2);
@@ -23,18 +28,66 @@ class ofxBezierDraw {
 
 		// Drawing Functions
 		void draw();
+		// Only the chunks of the stroke that overlap viewport are drawn, nothing at all if the curve is outside it
+		void draw(const ofRectangle & viewport);
 		void drawOutline();
 		void drawHelp();
-		void drawWithNormals(const ofPolyline & polyline);
-		void updateNormalLine(ofPolyline line);
+		// The normals of the stroke as short lines, one batched mesh built the first time it is drawn after a change
+		void drawNormals();
+		void drawProfilerOverlay(float x, float y);
+		// The editor's polyline changed, the culled draw uploads it again the next time it needs it
+		void markStrokeDirty();
+		// The fill is triangulated here once per change instead of on every draw
+		void updateFill(const ofPolyline & polyline);
+		void clearFill();
+		const ofVboMesh & getFillMesh(){
+			return fillMesh;
+		}
 
 	private:
 
 		ofxBezierEditorSettings & settings;
+		const ofxBezierProfiler & profiler;
+		const ofxBezierSegmentTree & segmentTree;
+		// the stroke the culled draw and the normals are drawn from, read in place rather than copied
+		const ofPolyline & polyline;
 		std::vector <draggableVertex> & curveVertices;
 		std::vector <draggableVertex> & controlPoint1;
 		std::vector <draggableVertex> & controlPoint2;
 		void onTriggerUpdate(TriggerUpdateEventArgs & args);
-		ofPolyline normalLine;
+
+		// the editor's placement, see ofxBezierEditorSettings::setTransform
+		void applyTransform();
+		void drawFill();
+		ofVboMesh fillMesh;
+		ofTessellator fillTessellator;
+		ofVbo strokeVbo;
+		bool bStrokeDirty = true;
+		// bumped by markStrokeDirty, the debug overlays are rebuilt when they are behind
+		unsigned int strokeRevision = 0;
+		void updateNormalMesh();
+		ofVboMesh normalMesh;
+		unsigned int normalMeshRevision = 0;
+
+		// All vertex and control point markers in two batched meshes, fills and outlines, coloured by handle state
+		void drawHandles();
+		// "v_0", "cp1_0", ... next to every handle, from a glyph mesh that is only rebuilt when the handle count changes
+		void drawHandleLabels();
+		void addHandleMarker(const glm::vec2 & center, float radius, const ofFloatColor & color, bool filled);
+		const int handleCircleResolution = 20;
+		std::vector <glm::vec2> unitCircle;
+		ofVboMesh handleFillMesh;
+		ofVboMesh handleLineMesh;
+		ofBitmapFont labelFont;
+		ofVboMesh labelMesh;
+		// glyph vertices relative to their label's origin and which handle each belongs to
+		std::vector <glm::vec3> labelGlyphVertices;
+		std::vector <int> labelGlyphOwners;
+		std::vector <glm::vec3> labelAnchors;
+		int labelHandleCount = -1;
+		bool bLabelsFlipped = false;
+		ofColor labelVertexColour;
+		ofColor labelControlColour;
+		std::vector <int> visibleLeaves;
 
 };
@@ -1,12 +1,31 @@
 #include "ofxBezierEditor.h"
-
+#include <atomic>
+#include <thread>
+
+namespace {
+	// points per segment of ofPolyline::bezierTo
+	const int polylineResolution = 20;
+
+	// the points bezierTo adds for a segment, with the same arithmetic so in place updates match a rebuild
+	void tessellateSegment(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, glm::vec3 * points){
+		glm::vec2 c = 3.0f * (c1 - p0);
+		glm::vec2 b = 3.0f * (c2 - c1) - c;
+		glm::vec2 a = p1 - p0 - c - b;
+		for(int i = 1; i <= polylineResolution; i++){
+			float t = (float)i / (float)polylineResolution;
+			float t2 = t * t;
+			float t3 = t2 * t;
+			points[i - 1] = glm::vec3((a.x * t3) + (b.x * t2) + (c.x * t) + p0.x, (a.y * t3) + (b.y * t2) + (c.y * t) + p0.y, 0);
+		}
+	}
+}
 
 ofxBezierEditor::ofxBezierEditor()
 	:   settings(*curveVertices, *controlPoint1, *controlPoint2),
 	tubeMeshBuilder(settings),
 	ribbonMeshBuilder(settings),
-	bezierDraw(settings, *curveVertices, *controlPoint1, *controlPoint2),
-	bezierUI(settings, *curveVertices, *controlPoint1, *controlPoint2){
+	bezierDraw(settings, profiler, segmentTree, polyLineFromPoints, *curveVertices, *controlPoint1, *controlPoint2),
+	bezierUI(settings, segmentTree, history, *curveVertices, *controlPoint1, *controlPoint2){
 
 	draggableVertex vtx;
 	curveVertices->assign(0, vtx);
@@ -18,16 +37,27 @@ ofxBezierEditor::ofxBezierEditor()
 	polyLineFromPoints.setClosed(false);
 
 	ofAddListener(triggerUpdateEvent, this, &ofxBezierEditor::onTriggerUpdate);
+	ofAddListener(ofEvents().update, this, &ofxBezierEditor::onUpdate);
 
 }
 
 ofxBezierEditor::~ofxBezierEditor(){
 	ofRemoveListener(triggerUpdateEvent, this, &ofxBezierEditor::onTriggerUpdate);
+	ofRemoveListener(ofEvents().update, this, &ofxBezierEditor::onUpdate);
 
 }
 
 void ofxBezierEditor::updateBoundingBox(){
-	settings.boundingBox = polyLineFromPoints.getBoundingBox();
+	// the union of the cached exact segment bounds, no need to go through the tessellated line
+	if(segmentTree.empty()){
+		if(curveVertices->size() > 0){
+			settings.boundingBox.set(curveVertices->at(0).pos.x, curveVertices->at(0).pos.y, 0, 0);
+		}else{
+			settings.boundingBox.set(0, 0, 0, 0);
+		}
+		return;
+	}
+	settings.boundingBox = segmentTree.getBounds();
 }
 
 void ofxBezierEditor::calculateCenter(){
@@ -35,17 +65,45 @@ void ofxBezierEditor::calculateCenter(){
 }
 
 void ofxBezierEditor::updatePolyline(){
+	// with the same segments as the last build only the ones whose points moved are tessellated again,
+	// the segment tree still holds the points they were built from
+	int segmentCount = curveVertices->size() < 2 ? 0 : (settings.bIsClosed ? curveVertices->size() : curveVertices->size() - 1);
+	const auto & segments = segmentTree.getSegments();
+	if(segmentCount > 0 && segments.size() == segmentCount && segmentPolylineStarts.size() == segmentCount &&
+	   polyLineFromPoints.size() == segmentCount * polylineResolution + 1 && polyLineFromPoints.isClosed() == settings.bIsClosed){
+		for(int i = 0; i < segmentCount; i++){
+			int next = (i + 1) % curveVertices->size();
+			const glm::vec2 & p0 = curveVertices->at(i).pos;
+			const glm::vec2 & c1 = controlPoint1->at(next).pos;
+			const glm::vec2 & c2 = controlPoint2->at(next).pos;
+			const glm::vec2 & p1 = curveVertices->at(next).pos;
+			if(p0 == segments[i].p0 && c1 == segments[i].c1 && c2 == segments[i].c2 && p1 == segments[i].p1){
+				continue;
+			}
+			// non const access also drops the polyline's cached lengths
+			auto & points = polyLineFromPoints.getVertices();
+			if(i == 0){
+				points[0] = glm::vec3(p0, 0);
+			}
+			tessellateSegment(p0, c1, c2, p1, &points[segmentPolylineStarts[i] + 1]);
+		}
+		return;
+	}
+
 	polyLineFromPoints.clear();
+	segmentPolylineStarts.clear();
 	if(curveVertices->size() > 0){
 
 		for(int i = 0; i < curveVertices->size(); i++){
 			if(i == 0){
 				polyLineFromPoints.addVertex(curveVertices->at(0).pos.x, curveVertices->at(0).pos.y); // we need to duplicate 0 for the curve to start at point 0
 			}else{
+				segmentPolylineStarts.push_back(polyLineFromPoints.size() - 1);
 				polyLineFromPoints.bezierTo(controlPoint1->at(i).pos.x, controlPoint1->at(i).pos.y, controlPoint2->at(i).pos.x, controlPoint2->at(i).pos.y, curveVertices->at(i).pos.x, curveVertices->at(i).pos.y);
 			}
 		}
 		if(settings.bIsClosed){
+			segmentPolylineStarts.push_back(polyLineFromPoints.size() - 1);
 			polyLineFromPoints.bezierTo(controlPoint1->at(0).pos.x, controlPoint1->at(0).pos.y, controlPoint2->at(0).pos.x, controlPoint2->at(0).pos.y, curveVertices->at(0).pos.x, curveVertices->at(0).pos.y);
 			polyLineFromPoints.setClosed(settings.bIsClosed);
 		}
@@ -59,45 +117,355 @@ void ofxBezierEditor::createLineFromPoints(std::vector<glm::vec3> points){
         controlPoint1->clear();
         controlPoint2->clear();
         
+        curveVertices->resize(points.size());
+        controlPoint1->resize(points.size());
+        controlPoint2->resize(points.size());
         for (int i = 0 ; i < points.size(); i++) {
             curveVertices->at(i).pos = points[i];
             controlPoint1->at(i).pos = points[i] + glm::vec3(0.5,0.5,0);
             controlPoint2->at(i).pos = points[i] - glm::vec3(0.5,0.5,0);
         }
-        updateAllFromVertices();
+        recordHistory("createLineFromPoints");
+        updateAllFromVertices("createLineFromPoints");
     }
     
 }
 
-void ofxBezierEditor::updateAllFromVertices(){
+void ofxBezierEditor::createLineFromPoints(const std::vector <glm::vec3> & points, float fitErrorTolerance, float cornerAngleDegrees){
+	if(points.size() < 2){
+		return;
+	}
+	std::vector <glm::vec2> vertices;
+	std::vector <glm::vec2> cp1;
+	std::vector <glm::vec2> cp2;
+	ofxBezierCurveFitter::FitCurve(points, fitErrorTolerance, cornerAngleDegrees, vertices, cp1, cp2);
+
+	curveVertices->assign(vertices.size(), draggableVertex());
+	controlPoint1->assign(cp1.size(), draggableVertex());
+	controlPoint2->assign(cp2.size(), draggableVertex());
+	for(int i = 0; i < vertices.size(); i++){
+		curveVertices->at(i).pos = vertices[i];
+		controlPoint1->at(i).pos = cp1[i];
+		controlPoint2->at(i).pos = cp2[i];
+	}
+	ofLogVerbose("ofxBezierEditor") << "createLineFromPoints: fitted " << points.size() << " points with " << vertices.size() - 1 << " segments";
+	recordHistory("createLineFromPoints");
+	updateAllFromVertices("createLineFromPoints");
+}
 
-	updatePolyline();
+void ofxBezierEditor::updateAllFromVertices(const std::string & trigger, int mergedEvents){
+	updateGeometry(trigger, mergedEvents);
+	finishUpdate();
+}
 
-	updateBoundingBox();
+void ofxBezierEditor::updateGeometry(const std::string & trigger, int mergedEvents){
+	OFX_BEZIER_PROFILE_BEGIN(profiler, trigger);
+	OFX_BEZIER_PROFILE_COUNT(profiler, mergedInputEvents, mergedEvents);
+	OFX_BEZIER_PROFILE_COUNT(profiler, curveVertices, curveVertices->size());
 
-	calculateCenter();
+	{
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_POLYLINE);
+		updatePolyline();
+	}
+	OFX_BEZIER_PROFILE_COUNT(profiler, polylineVertices, polyLineFromPoints.size());
+
+	{
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_SEGMENT_TREE);
+		// only read by the profiler, which can be compiled out
+		[[maybe_unused]] int changedSegments = segmentTree.update(*curveVertices, *controlPoint1, *controlPoint2, settings.bIsClosed, segmentPolylineStarts, polyLineFromPoints.size());
+		OFX_BEZIER_PROFILE_COUNT(profiler, changedSegments, changedSegments);
+		bezierDraw.markStrokeDirty();
+	}
 
-	if(settings.bUseRibbonMesh){
-		ribbonMeshBuilder.generateRibbonMeshFromPolyline(polyLineFromPoints);
+	{
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_BOUNDING_BOX);
+		updateBoundingBox();
+	}
 
+	{
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_CENTER);
+		calculateCenter();
 	}
-	if(settings.bUseTubeMesh){
-		tubeMeshBuilder.generateTubeMeshFromPolyline(polyLineFromPoints);
+
+	int qualityStep = 0;
+	if(settings.bProgressiveRefinement && settings.bInteracting){
+		lastInteractiveEditMicros = ofGetElapsedTimeMicros();
+		qualityStep = getInteractiveQualityStep();
+	}
+	updateMeshes(qualityStep, 0);
+
+	// chunks of a mesh that was switched off would otherwise be drawn stale
+	if(!settings.bUseRibbonMesh || !bUseChunkedMeshes){
+		chunkedRibbonMesh.clear();
+	}
+	if(!settings.bUseTubeMesh || !bUseChunkedMeshes){
+		chunkedTubeMesh.clear();
+	}
+
+	if(settings.bfillBezier && settings.bIsClosed){
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_FILL);
+		bezierDraw.updateFill(polyLineFromPoints);
+	}else{
+		bezierDraw.clearFill();
+	}
+}
+
+void ofxBezierEditor::finishUpdate(){
+	// the level of detail builders and the curve's meshes own vertex buffers, these stay on the GL thread
+	if(bUseMeshLod){
+		// only the coarsest level is built here, the others when they are first drawn
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_MESH_LOD);
+		meshLod.rebuild(polyLineFromPoints, settings);
+	}
+
+	if(attachedCurve != nullptr){
+		attachedCurve->setFromEditor(*curveVertices, *controlPoint1, *controlPoint2, settings, polyLineFromPoints, getRibbonMesh(), getTubeMesh());
+	}
+
+	OFX_BEZIER_PROFILE_END(profiler);
+}
+
+void ofxBezierEditor::updateMeshes(int qualityStep, uint64_t budgetMicros){
+	ofxBezierMeshSettings quality = getQualitySettings(qualityStep);
+	uint64_t startMicros = ofGetElapsedTimeMicros();
+
+	// the builders read the editor's settings, so the quality step is swapped in around the build
+	int fullMultiplier = settings.meshLengthPrecisionMultiplier;
+	int fullResolution = settings.tubeResolution;
+	float fullSpacing = settings.sampleSpacing;
+	settings.meshLengthPrecisionMultiplier = quality.meshLengthPrecisionMultiplier;
+	settings.tubeResolution = quality.tubeResolution;
+	settings.sampleSpacing = quality.sampleSpacing;
+
+	if(settings.bUseRibbonMesh && bUseChunkedMeshes){
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_RIBBON_MESH);
+		[[maybe_unused]] int rebuiltChunks = chunkedRibbonMesh.update(segmentTree, quality, budgetMicros);
+		OFX_BEZIER_PROFILE_COUNT(profiler, ribbonVertices, chunkedRibbonMesh.getVertexCount());
+		OFX_BEZIER_PROFILE_ADD(profiler, rebuiltChunks, rebuiltChunks);
+	}else if(settings.bUseRibbonMesh){
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_RIBBON_MESH);
+		// the segments give exact tangents, only simplification still needs the polyline
+		if(settings.simplifyTolerance > 0){
+			ribbonMeshBuilder.generateRibbonMeshFromPolyline(polyLineFromPoints);
+		}else{
+			ribbonMeshBuilder.generateRibbonMeshFromSegments(segmentTree.getSegments());
+		}
+		OFX_BEZIER_PROFILE_COUNT(profiler, ribbonVertices, ribbonMeshBuilder.getRibbonMesh().getNumVertices());
+		OFX_BEZIER_PROFILE_ADD(profiler, bufferGrowths, ribbonMeshBuilder.getBufferGrowths());
+		OFX_BEZIER_PROFILE_COUNT(profiler, simplifyReductionRatio, ribbonMeshBuilder.getSimplifyReductionRatio());
+		if(bPackedMeshesOnly){
+			// packed straight from the builder's buffers, which are then freed instead of kept next to the packed copy
+			ofMesh mesh;
+			ribbonMeshBuilder.moveRibbonMeshInto(mesh);
+			packedRibbonMesh.update(mesh);
+		}
+	}
+	if(settings.bUseTubeMesh && bUseChunkedMeshes){
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_TUBE_MESH);
+		[[maybe_unused]] int rebuiltChunks = chunkedTubeMesh.update(segmentTree, quality, budgetMicros);
+		OFX_BEZIER_PROFILE_COUNT(profiler, tubeVertices, chunkedTubeMesh.getVertexCount());
+		OFX_BEZIER_PROFILE_ADD(profiler, rebuiltChunks, rebuiltChunks);
+	}else if(settings.bUseTubeMesh){
+		OFX_BEZIER_PROFILE_STAGE(profiler, STAGE_TUBE_MESH);
+		if(settings.simplifyTolerance > 0){
+			tubeMeshBuilder.generateTubeMeshFromPolyline(polyLineFromPoints);
+		}else{
+			tubeMeshBuilder.generateTubeMeshFromSegments(segmentTree.getSegments());
+		}
+		OFX_BEZIER_PROFILE_COUNT(profiler, tubeVertices, tubeMeshBuilder.getTubeMesh().getNumVertices());
+		OFX_BEZIER_PROFILE_COUNT(profiler, tubeRings, tubeMeshBuilder.getRingCount());
+		OFX_BEZIER_PROFILE_ADD(profiler, bufferGrowths, tubeMeshBuilder.getBufferGrowths());
+		OFX_BEZIER_PROFILE_COUNT(profiler, simplifyReductionRatio, tubeMeshBuilder.getSimplifyReductionRatio());
+		if(bPackedMeshesOnly){
+			ofMesh mesh;
+			tubeMeshBuilder.moveTubeMeshInto(mesh);
+			packedTubeMesh.update(mesh);
+		}
+	}
+
+	settings.meshLengthPrecisionMultiplier = fullMultiplier;
+	settings.tubeResolution = fullResolution;
+	settings.sampleSpacing = fullSpacing;
+	// chunked meshes keep their chunks, they are packed from those when asked for
+	bPackedRibbonDirty = !bPackedMeshesOnly || bUseChunkedMeshes;
+	bPackedTubeDirty = !bPackedMeshesOnly || bUseChunkedMeshes;
+
+	meshQualityStep = qualityStep;
+	if(qualityStep < qualityStepMicros.size() && (!bUseChunkedMeshes || budgetMicros == 0)){
+		qualityStepMicros[qualityStep] = ofGetElapsedTimeMicros() - startMicros;
+	}
+}
+
+ofxBezierMeshSettings ofxBezierEditor::getQualitySettings(int qualityStep){
+	ofxBezierMeshSettings quality = settings;
+	quality.meshLengthPrecisionMultiplier = std::max(settings.meshLengthPrecisionMultiplier >> qualityStep, 1);
+	quality.tubeResolution = std::max(settings.tubeResolution >> qualityStep, std::min(settings.tubeResolution, 3));
+	quality.sampleSpacing = settings.sampleSpacing * (1 << qualityStep);
+	return quality;
+}
+
+int ofxBezierEditor::getInteractiveQualityStep(){
+	int steps = std::max(settings.refinementSteps, 0);
+	qualityStepMicros.resize(steps + 1, 0);
+	uint64_t budgetMicros = settings.refinementBudgetMillis * 1000;
+	// the finest step whose last build, or an estimate from the nearest step we timed, fits the budget.
+	// Every step halves the rings both ways, so it costs about a quarter of the one before it.
+	for(int step = 0; step <= steps; step++){
+		for(int timed = step; timed <= steps; timed++){
+			if(qualityStepMicros[timed] > 0){
+				if((qualityStepMicros[timed] << (2 * (timed - step))) <= budgetMicros){
+					return step;
+				}
+				break;
+			}
+		}
+	}
+	return steps;
+}
+
+bool ofxBezierEditor::isInteracting(){
+	return settings.bInteracting && ofGetElapsedTimeMicros() - lastInteractiveEditMicros < settings.refinementIdleMillis * 1000;
+}
+
+void ofxBezierEditor::onUpdate(ofEventArgs & args){
+	if(!settings.bInteracting){
+		history.seal();
+	}
+	if(!settings.bProgressiveRefinement || isInteracting()){
+		return;
 	}
-	bezierDraw.updateNormalLine(polyLineFromPoints);
+	bool bChunksPending = bUseChunkedMeshes && (!chunkedRibbonMesh.isComplete() || !chunkedTubeMesh.isComplete());
+	if(meshQualityStep == 0 && !bChunksPending){
+		return;
+	}
+
+	// chunked meshes go straight to full quality a few chunks per frame, whole meshes a step per frame
+	int step = bUseChunkedMeshes ? 0 : meshQualityStep - 1;
+	OFX_BEZIER_PROFILE_BEGIN(profiler, "refine");
+	updateMeshes(step, settings.refinementBudgetMillis * 1000);
+	OFX_BEZIER_PROFILE_END(profiler);
+
+	if(attachedCurve != nullptr && meshQualityStep == 0 && !(bUseChunkedMeshes && (!chunkedRibbonMesh.isComplete() || !chunkedTubeMesh.isComplete()))){
+		attachedCurve->setFromEditor(*curveVertices, *controlPoint1, *controlPoint2, settings, polyLineFromPoints, getRibbonMesh(), getTubeMesh());
+	}
+}
+
+void ofxBezierEditor::setProgressiveRefinement(bool value, float budgetMillis, int steps){
+	settings.bProgressiveRefinement = value;
+	settings.refinementBudgetMillis = budgetMillis;
+	settings.setRefinementSteps(steps);
+	qualityStepMicros.clear();
+}
 
+bool ofxBezierEditor::getProgressiveRefinement(){
+	return settings.bProgressiveRefinement;
 }
 
 void ofxBezierEditor::draw(){
 	bezierDraw.draw();
 }
 
+void ofxBezierEditor::draw(const ofRectangle & viewport){
+	bezierDraw.draw(viewport);
+}
+
+ofxBezierSegmentTree::ClosestPoint ofxBezierEditor::closestPoint(const glm::vec2 & point, float maxDistance){
+	return segmentTree.closestPoint(point, maxDistance);
+}
+
+void ofxBezierEditor::closestPoints(const std::vector <glm::vec2> & points, std::vector <ofxBezierSegmentTree::ClosestPoint> & results, float maxDistance){
+	segmentTree.closestPoints(points, results, maxDistance);
+}
+
+void ofxBezierEditor::insertVertexOnSegment(int segment, float t){
+	bezierUI.insertVertexOnSegment(segment, t);
+	updateAllFromVertices("insertVertexOnSegment");
+}
+
+bool ofxBezierEditor::contains(const glm::vec2 & point){
+	if(!settings.bIsClosed || !settings.boundingBox.inside(point.x, point.y)){
+		return false;
+	}
+	return segmentTree.getWindingNumber(point) % 2 != 0;
+}
+
+void ofxBezierEditor::contains(const std::vector <glm::vec2> & points, std::vector <bool> & results){
+	results.assign(points.size(), false);
+	if(!settings.bIsClosed){
+		return;
+	}
+	std::vector <int> windingNumbers;
+	segmentTree.getWindingNumbers(points, windingNumbers);
+	for(int i = 0; i < points.size(); i++){
+		results[i] = windingNumbers[i] % 2 != 0;
+	}
+}
+
+void ofxBezierEditor::intersect(ofxBezierEditor & other, std::vector <ofxBezierIntersector::Hit> & hits, float tolerance){
+	ofxBezierIntersector::Intersect(segmentTree, other.segmentTree, hits, tolerance);
+}
+
+void ofxBezierEditor::getSelfIntersections(std::vector <ofxBezierIntersector::Hit> & hits, float tolerance){
+	ofxBezierIntersector::SelfIntersect(segmentTree, hits, tolerance);
+}
+
+void ofxBezierEditor::raycast(const glm::vec2 & origin, const glm::vec2 & direction, std::vector <ofxBezierIntersector::RayHit> & hits, float maxDistance){
+	ofxBezierIntersector::Raycast(segmentTree, origin, direction, hits, 0.01, maxDistance);
+}
+
+bool ofxBezierEditor::isVisible(const ofRectangle & viewport){
+	if(segmentTree.empty()){
+		return false;
+	}
+	// meshes stick out of the curve by up to half the ribbon or the tube radius
+	float margin = 0;
+	if(settings.bUseRibbonMesh){
+		margin = std::max(margin, settings.ribbonWidth * 0.5f);
+	}
+	if(settings.bUseTubeMesh){
+		margin = std::max(margin, settings.tubeRadius);
+	}
+	ofRectangle bounds = segmentTree.getBounds();
+	bounds.set(bounds.x - margin, bounds.y - margin, bounds.width + margin * 2, bounds.height + margin * 2);
+	return bounds.intersects(settings.toCurveCoordinates(viewport));
+}
+
+void ofxBezierEditor::setTransform(const glm::vec2 & translation, float rotation, float scale){
+	settings.setTransform(translation, rotation, scale);
+}
+
+void ofxBezierEditor::setTransformPivot(const glm::vec2 & pivot){
+	settings.setTransformPivot(pivot);
+}
+
+glm::mat4 ofxBezierEditor::getTransformMatrix(){
+	return settings.getTransformMatrix();
+}
+
+bool ofxBezierEditor::hasTransform(){
+	return settings.hasTransform();
+}
+
+glm::vec2 ofxBezierEditor::toCurveCoordinates(const glm::vec2 & point){
+	return settings.toCurveCoordinates(point);
+}
+
+void ofxBezierEditor::bakeTransform(){
+	if(!settings.hasTransform()){
+		return;
+	}
+	settings.bakeTransform();
+	recordHistory("bakeTransform");
+	updateAllFromVertices("bakeTransform");
+}
+
 void ofxBezierEditor::drawHelp(){
 	bezierDraw.drawHelp();
 }
 
 void ofxBezierEditor::loadPoints(string filename){
 	settings.loadPoints(filename);
+	recordHistory("loadPoints");
 }
 
 void ofxBezierEditor::savePoints(string filename){
@@ -106,7 +474,10 @@ void ofxBezierEditor::savePoints(string filename){
 
 void ofxBezierEditor::setFillBezier(bool value){
 	settings.bfillBezier = value;
-	updateAllFromVertices();
+	if(attachedCurve != nullptr){
+		attachedCurve->setFillBezier(value);
+	}
+	updateAllFromVertices("setFillBezier");
 }
 
 bool ofxBezierEditor::getFillBezier(){
@@ -115,7 +486,8 @@ bool ofxBezierEditor::getFillBezier(){
 
 void ofxBezierEditor::setClosed(bool value){
 	settings.bIsClosed = value;
-	updateAllFromVertices();
+	recordHistory("setClosed");
+	updateAllFromVertices("setClosed");
 }
 
 bool ofxBezierEditor::getClosed(){
@@ -124,7 +496,7 @@ bool ofxBezierEditor::getClosed(){
 
 void ofxBezierEditor::setRibbonWidth(float value){
 	settings.ribbonWidth = value;
-	updateAllFromVertices();
+	updateAllFromVertices("setRibbonWidth");
 }
 
 float ofxBezierEditor::getRibbonWidth(){
@@ -133,7 +505,10 @@ float ofxBezierEditor::getRibbonWidth(){
 
 void ofxBezierEditor::setColorFill(ofColor value){
 	settings.colorFill = value;
-	updateAllFromVertices();
+	if(attachedCurve != nullptr){
+		attachedCurve->setColorFill(value);
+	}
+	updateAllFromVertices("setColorFill");
 }
 
 ofColor ofxBezierEditor::getColourFill(){
@@ -142,7 +517,10 @@ ofColor ofxBezierEditor::getColourFill(){
 
 void ofxBezierEditor::setColorStroke(ofColor value){
 	settings.colorStroke = value;
-	updateAllFromVertices();
+	if(attachedCurve != nullptr){
+		attachedCurve->setColorStroke(value);
+	}
+	updateAllFromVertices("setColorStroke");
 }
 
 ofColor ofxBezierEditor::getColourStroke(){
@@ -151,7 +529,7 @@ ofColor ofxBezierEditor::getColourStroke(){
 
 void ofxBezierEditor::setMeshLengthPrecisionMultiplier(int value){
 	settings.meshLengthPrecisionMultiplier = value;
-	updateAllFromVertices();
+	updateAllFromVertices("setMeshLengthPrecisionMultiplier");
 }
 
 int ofxBezierEditor::getMeshLengthPrecisionMultiplier(){
@@ -160,7 +538,7 @@ int ofxBezierEditor::getMeshLengthPrecisionMultiplier(){
 
 void ofxBezierEditor::setTubeRadius(float value){
 	settings.tubeRadius = value;
-	updateAllFromVertices();
+	updateAllFromVertices("setTubeRadius");
 }
 
 float ofxBezierEditor::getTubeRadius(){
@@ -169,7 +547,7 @@ float ofxBezierEditor::getTubeRadius(){
 
 void ofxBezierEditor::setTubeResolution(int value){
 	settings.tubeResolution = value;
-	updateAllFromVertices();
+	updateAllFromVertices("setTubeResolution");
 }
 
 int ofxBezierEditor::getTubeResolution(){
@@ -178,7 +556,7 @@ int ofxBezierEditor::getTubeResolution(){
 
 void ofxBezierEditor::setHasRoundCaps(bool value){
 	settings.roundCap = value;
-	updateAllFromVertices();
+	updateAllFromVertices("setHasRoundCaps");
 }
 
 bool ofxBezierEditor::getHasRoundCaps(){
@@ -187,7 +565,7 @@ bool ofxBezierEditor::getHasRoundCaps(){
 
 void ofxBezierEditor::setUseRibbonMesh(bool value){
 	settings.bUseRibbonMesh = value;
-	updateAllFromVertices();
+	updateAllFromVertices("setUseRibbonMesh");
 }
 
 bool ofxBezierEditor::getUseRibbonMesh(){
@@ -202,26 +580,319 @@ bool ofxBezierEditor::getUseTubeMesh(){
 	return settings.bUseTubeMesh;
 }
 
-ofVboMesh ofxBezierEditor::getRibbonMeshFromPolyline(ofPolyline polyline){
-	return ribbonMeshBuilder.getRibbonMeshFromPolyline(polyline);
+ofVboMesh ofxBezierEditor::getRibbonMeshFromPolyline(const ofPolyline & polyline){
+	ofVboMesh mesh;
+	ofxBezierRibbonMeshBuilder::BuildRibbonMesh(polyline, settings, mesh);
+	return mesh;
 }
 
-ofVboMesh ofxBezierEditor::getTubeMeshFromPolyline(ofPolyline polyline){
-	return tubeMeshBuilder.getTubeMeshFromPolyline(polyline);
+ofVboMesh ofxBezierEditor::getTubeMeshFromPolyline(const ofPolyline & polyline){
+	ofVboMesh mesh;
+	ofxBezierTubeMeshBuilder::BuildTubeMesh(polyline, settings, mesh);
+	return mesh;
 }
 
 ofVboMesh ofxBezierEditor::getRibbonMesh(){
+	if(bUseChunkedMeshes){
+		return chunkedRibbonMesh.getMesh();
+	}
 	return ribbonMeshBuilder.getRibbonMesh();
 }
 
 ofVboMesh ofxBezierEditor::getTubeMesh(){
+	if(bUseChunkedMeshes){
+		return chunkedTubeMesh.getMesh();
+	}
 	return tubeMeshBuilder.getTubeMesh();
 }
 
+void ofxBezierEditor::setSimplifyTolerance(float tolerance, float maxAngleDegrees){
+	settings.simplifyTolerance = tolerance;
+	settings.simplifyMaxAngle = maxAngleDegrees;
+	updateAllFromVertices("setSimplifyTolerance");
+}
+
+float ofxBezierEditor::getSimplifyTolerance(){
+	return settings.simplifyTolerance;
+}
+
+float ofxBezierEditor::getSimplifyReductionRatio(){
+	if(settings.bUseTubeMesh){
+		return tubeMeshBuilder.getSimplifyReductionRatio();
+	}
+	return ribbonMeshBuilder.getSimplifyReductionRatio();
+}
+
+void ofxBezierEditor::setArcLengthSampling(bool value, float spacing, float curvatureWeight){
+	settings.setArcLengthSampling(value, spacing, curvatureWeight);
+	updateAllFromVertices("setArcLengthSampling");
+}
+
+bool ofxBezierEditor::getArcLengthSampling(){
+	return settings.getArcLengthSampling();
+}
+
+void ofxBezierEditor::setMeshAttributes(bool normals, bool texCoords){
+	settings.setMeshAttributes(normals, texCoords);
+	updateAllFromVertices("setMeshAttributes");
+}
+
+bool ofxBezierEditor::getMeshNormals(){
+	return settings.getMeshNormals();
+}
+
+bool ofxBezierEditor::getMeshTexCoords(){
+	return settings.getMeshTexCoords();
+}
+
+void ofxBezierEditor::setPackedMeshFormat(const ofxBezierPackedMesh::Format & format){
+	packedRibbonMesh.setFormat(format);
+	packedTubeMesh.setFormat(format);
+	if(bPackedMeshesOnly && !bUseChunkedMeshes){
+		// there are no float meshes left to pack from
+		updateAllFromVertices("setPackedMeshFormat");
+	}else{
+		bPackedRibbonDirty = true;
+		bPackedTubeDirty = true;
+	}
+}
+
+void ofxBezierEditor::setPackedMeshesOnly(bool value){
+	bPackedMeshesOnly = value;
+	updateAllFromVertices("setPackedMeshesOnly");
+}
+
+bool ofxBezierEditor::getPackedMeshesOnly(){
+	return bPackedMeshesOnly;
+}
+
+ofxBezierPackedMesh & ofxBezierEditor::getPackedRibbonMesh(){
+	if(bPackedRibbonDirty){
+		packedRibbonMesh.update(getRibbonMesh());
+		bPackedRibbonDirty = false;
+	}
+	return packedRibbonMesh;
+}
+
+ofxBezierPackedMesh & ofxBezierEditor::getPackedTubeMesh(){
+	if(bPackedTubeDirty){
+		packedTubeMesh.update(getTubeMesh());
+		bPackedTubeDirty = false;
+	}
+	return packedTubeMesh;
+}
+
+void ofxBezierEditor::setUseChunkedMeshes(bool value){
+	bUseChunkedMeshes = value;
+	updateAllFromVertices("setUseChunkedMeshes");
+}
+
+bool ofxBezierEditor::getUseChunkedMeshes(){
+	return bUseChunkedMeshes;
+}
+
+void ofxBezierEditor::drawRibbonMesh(){
+	drawChunkedMesh(chunkedRibbonMesh, nullptr);
+}
+
+void ofxBezierEditor::drawTubeMesh(){
+	drawChunkedMesh(chunkedTubeMesh, nullptr);
+}
+
+void ofxBezierEditor::drawRibbonMesh(const ofRectangle & viewport){
+	drawChunkedMesh(chunkedRibbonMesh, &viewport);
+}
+
+void ofxBezierEditor::drawTubeMesh(const ofRectangle & viewport){
+	drawChunkedMesh(chunkedTubeMesh, &viewport);
+}
+
+void ofxBezierEditor::drawChunkedMesh(ofxBezierChunkedMesh & mesh, const ofRectangle * viewport){
+	ofPushMatrix();
+	if(settings.hasTransform()){
+		ofMultMatrix(settings.getTransformMatrix());
+	}
+	if(viewport != nullptr){
+		mesh.draw(segmentTree, settings.toCurveCoordinates(*viewport));
+	}else{
+		mesh.draw();
+	}
+	ofPopMatrix();
+}
+
+void ofxBezierEditor::setUseMeshLod(bool value, int levelCount){
+	bUseMeshLod = value;
+	meshLod.setLevelCount(levelCount);
+	if(bUseMeshLod){
+		updateAllFromVertices("setUseMeshLod");
+	}
+}
+
+bool ofxBezierEditor::getUseMeshLod(){
+	return bUseMeshLod;
+}
+
+const ofVboMesh & ofxBezierEditor::getRibbonMeshForProjectedSize(float projectedSize){
+	return meshLod.getRibbonMesh(meshLod.getLevelForProjectedSize(projectedSize));
+}
+
+const ofVboMesh & ofxBezierEditor::getTubeMeshForProjectedSize(float projectedSize){
+	return meshLod.getTubeMesh(meshLod.getLevelForProjectedSize(projectedSize));
+}
+
+const ofVboMesh & ofxBezierEditor::getRibbonMeshForCamera(const ofCamera & camera){
+	return meshLod.getRibbonMesh(getMeshLodLevelForCamera(camera));
+}
+
+const ofVboMesh & ofxBezierEditor::getTubeMeshForCamera(const ofCamera & camera){
+	return meshLod.getTubeMesh(getMeshLodLevelForCamera(camera));
+}
+
+int ofxBezierEditor::getMeshLodLevelForCamera(const ofCamera & camera){
+	float distance = glm::distance(camera.getGlobalPosition(), glm::vec3(center.x, center.y, 0));
+	return meshLod.getLevelForCameraDistance(distance, camera.getFov(), ofGetHeight());
+}
+
 void ofxBezierEditor::setReactToMouseAndKeyEvents(bool value){
 	bezierUI.setReactToMouseAndKeyEvents(value);
 }
 
+void ofxBezierEditor::attachCurve(ofxBezierCurve & curve){
+	// the curve we are leaving keeps where it was moved to
+	bakeTransform();
+	settings.resetTransform();
+	attachedCurve = nullptr;
+
+	auto copyPoints = [](const std::vector <glm::vec2> & from, std::vector <draggableVertex> & to){
+		to.assign(from.size(), draggableVertex());
+		for(int i = 0; i < from.size(); i++){
+			to[i].pos = from[i];
+		}
+	};
+	copyPoints(curve.getVertices(), *curveVertices);
+	copyPoints(curve.getControlPoints1(), *controlPoint1);
+	copyPoints(curve.getControlPoints2(), *controlPoint2);
+
+	static_cast <ofxBezierMeshSettings &>(settings) = curve.getSettings();
+	settings.bfillBezier = curve.getFillBezier();
+	settings.colorFill = curve.getColorFill();
+	settings.colorStroke = curve.getColorStroke();
+
+	attachedCurve = &curve;
+	updateAllFromVertices("attachCurve");
+}
+
+void ofxBezierEditor::detachCurve(){
+	bakeTransform();
+	attachedCurve = nullptr;
+}
+
+void ofxBezierEditor::recordHistory(const std::string & label){
+	history.record(*curveVertices, *controlPoint1, *controlPoint2, settings.bIsClosed, label);
+}
+
 void ofxBezierEditor::onTriggerUpdate(TriggerUpdateEventArgs & args){
-	updateAllFromVertices();
+	updateAllFromVertices(args.source, args.mergedEvents);
+}
+
+bool ofxBezierEditor::undo(){
+	if(!bezierUI.undo()){
+		return false;
+	}
+	updateAllFromVertices("undo");
+	return true;
+}
+
+bool ofxBezierEditor::redo(){
+	if(!bezierUI.redo()){
+		return false;
+	}
+	updateAllFromVertices("redo");
+	return true;
+}
+
+bool ofxBezierEditor::setAnimationTime(float time){
+	if(animation.evaluate(time, *curveVertices, *controlPoint1, *controlPoint2) == 0){
+		return false;
+	}
+	// animated points aren't an edit, the next undo goes back to before the last real change
+	history.rebase(*curveVertices, *controlPoint1, *controlPoint2, settings.bIsClosed);
+	updateAllFromVertices("animation");
+	return true;
+}
+
+void ofxBezierEditor::SetAnimationTime(const std::vector <ofxBezierEditor *> & editors, float time, int threadCount){
+	if(threadCount <= 0){
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threadCount = std::max(1, std::min(threadCount, (int)editors.size()));
+
+	// every editor only touches its own points and CPU meshes, the workers take them off a shared counter
+	std::vector <char> moved(editors.size(), 0);
+	std::atomic <size_t> nextEditor(0);
+	auto work = [&](){
+		size_t index;
+		while((index = nextEditor++) < editors.size()){
+			ofxBezierEditor & editor = *editors[index];
+			if(editor.animation.evaluate(time, *editor.curveVertices, *editor.controlPoint1, *editor.controlPoint2) > 0){
+				editor.history.rebase(*editor.curveVertices, *editor.controlPoint1, *editor.controlPoint2, editor.settings.bIsClosed);
+				editor.updateGeometry("animation", 0);
+				moved[index] = 1;
+			}
+		}
+	};
+	std::vector <std::thread> threads;
+	for(int i = 1; i < threadCount; i++){
+		threads.push_back(std::thread(work));
+	}
+	work();
+	for(auto & thread : threads){
+		thread.join();
+	}
+
+	for(int i = 0; i < editors.size(); i++){
+		if(moved[i]){
+			editors[i]->finishUpdate();
+		}
+	}
+}
+
+bool ofxBezierEditor::recoverFromJournal(string filename){
+	std::vector <ofxBezierHistory::Point> points;
+	bool closed;
+	if(!ofxBezierHistory::ReadJournal(filename, points, closed)){
+		return false;
+	}
+	curveVertices->resize(points.size());
+	controlPoint1->resize(points.size());
+	controlPoint2->resize(points.size());
+	for(int i = 0; i < points.size(); i++){
+		curveVertices->at(i).pos = points[i].vertex;
+		controlPoint1->at(i).pos = points[i].control1;
+		controlPoint2->at(i).pos = points[i].control2;
+	}
+	settings.bIsClosed = closed;
+	recordHistory("recoverFromJournal");
+	updateAllFromVertices("recoverFromJournal");
+	return true;
+}
+
+bool ofxBezierEditor::saveProfilerTrace(string filename){
+	return profiler.saveChromeTrace(filename);
+}
+
+size_t ofxBezierEditor::getDragEventCount(){
+	return bezierUI.getDragEventCount();
+}
+
+size_t ofxBezierEditor::getMergedDragEventCount(){
+	return bezierUI.getMergedDragEventCount();
+}
+
+void ofxBezierEditor::setShowProfilerOverlay(bool value){
+	settings.bShowProfilerOverlay = value;
+}
+
+bool ofxBezierEditor::getShowProfilerOverlay(){
+	return settings.bShowProfilerOverlay;
 }
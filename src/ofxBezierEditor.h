@@ -9,6 +9,16 @@
 #include "ofxBezierEditorSettings.h"
 #include "draggableVertex.h"
 #include "ofxBezierEvents.h"
+#include "ofxBezierProfiler.h"
+#include "ofxBezierCurve.h"
+#include "ofxBezierCurveFitter.h"
+#include "ofxBezierMeshLod.h"
+#include "ofxBezierSegmentTree.h"
+#include "ofxBezierIntersector.h"
+#include "ofxBezierChunkedMesh.h"
+#include "ofxBezierPackedMesh.h"
+#include "ofxBezierHistory.h"
+#include "ofxBezierAnimation.h"
 
 
 class ofxBezierEditor {
@@ -28,8 +38,48 @@ class ofxBezierEditor {
 		}
 
 		void draw();
+		// Draws only what overlaps viewport (in curve coordinates), for big canvases seen through a small window
+		void draw(const ofRectangle & viewport);
 		void drawHelp();
 
+		// Bounding hierarchy over the cubic segments, the broad phase for culling and queries
+		const ofxBezierSegmentTree & getSegmentTree(){
+			return segmentTree;
+		}
+		// Nearest point on the curve, segment is -1 if the curve is empty or further than maxDistance
+		ofxBezierSegmentTree::ClosestPoint closestPoint(const glm::vec2 & point, float maxDistance = std::numeric_limits <float>::max());
+		void closestPoints(const std::vector <glm::vec2> & points, std::vector <ofxBezierSegmentTree::ClosestPoint> & results, float maxDistance = std::numeric_limits <float>::max());
+		// Adds a vertex at t on a segment without changing the shape, e.g. at a closestPoint() result
+		void insertVertexOnSegment(int segment, float t);
+
+		// Point in shape for closed curves, with the same even-odd rule the fill is drawn with
+		bool contains(const glm::vec2 & point);
+		void contains(const std::vector <glm::vec2> & points, std::vector <bool> & results);
+		// The triangulated fill, rebuilt when the shape changes while fill is on
+		const ofVboMesh & getFillMesh(){
+			return bezierDraw.getFillMesh();
+		}
+
+		// Crossings with another editor's curve and with itself, see ofxBezierIntersector::IntersectAll for many curves at once
+		void intersect(ofxBezierEditor & other, std::vector <ofxBezierIntersector::Hit> & hits, float tolerance = 0.01);
+		void getSelfIntersections(std::vector <ofxBezierIntersector::Hit> & hits, float tolerance = 0.01);
+		void raycast(const glm::vec2 & origin, const glm::vec2 & direction, std::vector <ofxBezierIntersector::RayHit> & hits, float maxDistance = std::numeric_limits <float>::max());
+
+		// Moves, turns (degrees) and scales the whole shape when it is drawn, without rebuilding anything.
+		// Dragging the bounding box in the editor only changes the translation. Queries, getPolyline() and
+		// the meshes stay in curve coordinates until bakeTransform(); saved files always hold baked points.
+		void setTransform(const glm::vec2 & translation, float rotation = 0, float scale = 1);
+		// rotation and scale are around pivot, e.g. getCenter()
+		void setTransformPivot(const glm::vec2 & pivot);
+		glm::mat4 getTransformMatrix();
+		bool hasTransform();
+		glm::vec2 toCurveCoordinates(const glm::vec2 & point);
+		// Moves the points to where they are drawn, resets the transform and rebuilds once
+		void bakeTransform();
+
+		// Whether anything of the curve, including the ribbon or tube around it, can be inside viewport
+		bool isVisible(const ofRectangle & viewport);
+
 		void loadPoints(string filename);
 		void savePoints(string filename);
 		void setFillBezier(bool value);
@@ -55,35 +105,191 @@ class ofxBezierEditor {
 		void setUseTubeMesh(bool value);
 		bool getUseTubeMesh();
 
+		// Simplify the polyline before meshing, vertices within tolerance of the simplified line are
+		// dropped unless the line turns by more than maxAngleDegrees there. 0 turns it off.
+		void setSimplifyTolerance(float tolerance, float maxAngleDegrees = 30);
+		float getSimplifyTolerance();
+		// input vertices over meshed vertices of the last build
+		float getSimplifyReductionRatio();
+
+		// Space the mesh rings by length along the curve, spacing apart in curve units, instead of by
+		// polyline index. curvatureWeight adds that many rings per radian the curve turns.
+		void setArcLengthSampling(bool value, float spacing = 4, float curvatureWeight = 0);
+		bool getArcLengthSampling();
+
+		// Leave normals or texture coordinates out of the ribbon and tube, e.g. for flat colour wireframes
+		// or a shader that works out its own normals
+		void setMeshAttributes(bool normals, bool texCoords);
+		bool getMeshNormals();
+		bool getMeshTexCoords();
+
+		// The ribbon and tube in compact vertex formats. They are packed when asked for and again only
+		// after the meshes change, so an editor that never asks pays nothing.
+		void setPackedMeshFormat(const ofxBezierPackedMesh::Format & format);
+		ofxBezierPackedMesh & getPackedRibbonMesh();
+		ofxBezierPackedMesh & getPackedTubeMesh();
+		// For curves that are only drawn packed: the meshes are packed as they are built and the float
+		// ribbon and tube are freed, so getRibbonMesh() and getTubeMesh() (and attached curves) get empty meshes.
+		// Chunked meshes need their chunks and keep them.
+		void setPackedMeshesOnly(bool value);
+		bool getPackedMeshesOnly();
+
 		void setReactToMouseAndKeyEvents(bool value);
 
 		ofVboMesh getRibbonMesh();
-		ofVboMesh getRibbonMeshFromPolyline(ofPolyline polyline);
+		// Meshes any polyline with this editor's mesh settings, the editor's own meshes are left alone
+		ofVboMesh getRibbonMeshFromPolyline(const ofPolyline & polyline);
 
 		ofVboMesh getTubeMesh();
-		ofVboMesh getTubeMeshFromPolyline(ofPolyline polyline);
+		ofVboMesh getTubeMeshFromPolyline(const ofPolyline & polyline);
     
         void createLineFromPoints(std::vector<glm::vec3> points);
+		// Fits a few smooth cubic segments to dense input (e.g. freehand samples) instead of
+		// making every point an anchor. No sample ends up further than fitErrorTolerance from
+		// the curve, turns sharper than cornerAngleDegrees are kept as corners.
+		void createLineFromPoints(const std::vector <glm::vec3> & points, float fitErrorTolerance, float cornerAngleDegrees = 60);
+
+		// Build the ribbon and tube in chunks that follow the segment tree leaves, each with its own buffer.
+		// An edit then only rebuilds and uploads the chunks around the segments that changed. getRibbonMesh()
+		// and getTubeMesh() still work but have to join the chunks, draw with the functions below instead.
+		void setUseChunkedMeshes(bool value);
+		bool getUseChunkedMeshes();
+		ofxBezierChunkedMesh & getChunkedRibbonMesh(){
+			return chunkedRibbonMesh;
+		}
+		ofxBezierChunkedMesh & getChunkedTubeMesh(){
+			return chunkedTubeMesh;
+		}
+		// Draw the chunked meshes with the editor's transform, the viewport versions skip chunks outside it
+		void drawRibbonMesh();
+		void drawTubeMesh();
+		void drawRibbonMesh(const ofRectangle & viewport);
+		void drawTubeMesh(const ofRectangle & viewport);
+
+		// Progressive refinement: while a handle is dragged the ribbon and tube are built at the finest of steps
+		// quality steps (each halves the rings along the curve and around the tube) expected to fit in budgetMillis.
+		// Once input is idle they are refined over the next frames, chunked meshes within the budget per frame.
+		void setProgressiveRefinement(bool value, float budgetMillis = 8, int steps = 3);
+		bool getProgressiveRefinement();
+		// 0 when the meshes are at full quality
+		int getMeshQualityStep(){
+			return meshQualityStep;
+		}
+
+		// Level of detail: keep a chain of coarser meshes next to the full one and pick one per draw.
+		// projectedSize is how many pixels the curve's bounding box covers on screen.
+		void setUseMeshLod(bool value, int levelCount = 4);
+		bool getUseMeshLod();
+		ofxBezierMeshLod & getMeshLod(){
+			return meshLod;
+		}
+		const ofVboMesh & getRibbonMeshForProjectedSize(float projectedSize);
+		const ofVboMesh & getTubeMeshForProjectedSize(float projectedSize);
+		const ofVboMesh & getRibbonMeshForCamera(const ofCamera & camera);
+		const ofVboMesh & getTubeMeshForCamera(const ofCamera & camera);
+
+		// Edit a render-only curve with this editor's UI. Every change is pushed back to the
+		// curve until it is detached, so one editor can serve any number of curves.
+		void attachCurve(ofxBezierCurve & curve);
+		void detachCurve();
+		ofxBezierCurve * getAttachedCurve(){
+			return attachedCurve;
+		}
+
+		// Every change to the points is recorded as a small delta, a drag is one step. The UI undoes with
+		// 'z' and redoes with 'y'. See ofxBezierHistory for the memory budget and the crash journal.
+		bool undo();
+		bool redo();
+		ofxBezierHistory & getHistory(){
+			return history;
+		}
+		// Replaces the points with the ones replayed from a journal, as one undoable change
+		bool recoverFromJournal(string filename);
+
+		// Keyframe tracks for the handles, see ofxBezierAnimation. Key the current shape with
+		// getAnimation().setKeyframes(time, *curveVertices, *controlPoint1, *controlPoint2).
+		ofxBezierAnimation & getAnimation(){
+			return animation;
+		}
+		// Moves the animated handles to time and rebuilds what they touch, returns false if nothing moved.
+		// Only the polyline segments next to moved handles are tessellated again, and with chunked meshes
+		// only their chunks are re-meshed. Animated changes aren't recorded for undo.
+		bool setAnimationTime(float time);
+		// setAnimationTime() on many editors at once, spread over threadCount threads (0 uses one per core).
+		// The workers only rebuild the CPU side (polyline, segment tree, meshes); level of detail meshes and
+		// attached curves hold GL objects and are updated on the calling thread afterwards, so call it from the GL thread.
+		static void SetAnimationTime(const std::vector <ofxBezierEditor *> & editors, float time, int threadCount = 0);
+
+		// Per-stage timings and counters of updateAllFromVertices
+		ofxBezierProfiler & getProfiler(){
+			return profiler;
+		}
+		bool saveProfilerTrace(string filename);
+		// Mouse drags are applied once per frame however fast the device sends them. These count the
+		// drag events received and how many of them were folded into another event's update.
+		size_t getDragEventCount();
+		size_t getMergedDragEventCount();
+		void setShowProfilerOverlay(bool value);
+		bool getShowProfilerOverlay();
 
 	private:
 
 		ofxBezierEditorSettings settings;
+		ofxBezierProfiler profiler;
+		ofxBezierSegmentTree segmentTree;
+		ofxBezierHistory history;
+		ofxBezierAnimation animation;
 		ofxBezierTubeMeshBuilder tubeMeshBuilder;
 		ofxBezierRibbonMeshBuilder ribbonMeshBuilder;
 		ofxBezierDraw bezierDraw;
 		ofxBezierUI bezierUI;
 
+		ofxBezierCurve * attachedCurve = nullptr;
+
+		ofxBezierMeshLod meshLod;
+		bool bUseMeshLod = false;
+
+		ofxBezierChunkedMesh chunkedRibbonMesh = ofxBezierChunkedMesh(ofxBezierChunkedMesh::RIBBON);
+		ofxBezierChunkedMesh chunkedTubeMesh = ofxBezierChunkedMesh(ofxBezierChunkedMesh::TUBE);
+		bool bUseChunkedMeshes = false;
+
+		ofxBezierPackedMesh packedRibbonMesh;
+		ofxBezierPackedMesh packedTubeMesh;
+		bool bPackedRibbonDirty = true;
+		bool bPackedTubeDirty = true;
+		bool bPackedMeshesOnly = false;
+		void drawChunkedMesh(ofxBezierChunkedMesh & mesh, const ofRectangle * viewport);
+
+		// ribbon and tube at a quality step, 0 is full quality
+		void updateMeshes(int qualityStep, uint64_t budgetMicros);
+		ofxBezierMeshSettings getQualitySettings(int qualityStep);
+		int getInteractiveQualityStep();
+		bool isInteracting();
+		void onUpdate(ofEventArgs & args);
+		int meshQualityStep = 0;
+		// how long the last full build at every quality step took, 0 if we haven't timed it yet
+		std::vector <uint64_t> qualityStepMicros;
+		uint64_t lastInteractiveEditMicros = 0;
+		int getMeshLodLevelForCamera(const ofCamera & camera);
+
 		void updateBoundingBox();
 
 		ofPoint center;
 		void calculateCenter();
 
 		ofPolyline polyLineFromPoints;
+		// index of the polyline vertex each segment starts at
+		std::vector <int> segmentPolylineStarts;
 		void updatePolyline();
 
-		void updateAllFromVertices();
+		void updateAllFromVertices(const std::string & trigger, int mergedEvents = 0);
+		// the two halves of updateAllFromVertices, the first only touches CPU data and can run on a worker thread
+		void updateGeometry(const std::string & trigger, int mergedEvents);
+		void finishUpdate();
 
 		void onTriggerUpdate(TriggerUpdateEventArgs & args);
+		// called by everything that changes the points, rebuilds alone don't touch the history
+		void recordHistory(const std::string & label);
 
 };
 
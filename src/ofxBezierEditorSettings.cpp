@@ -30,26 +30,87 @@ ofxBezierEditorSettings::~ofxBezierEditorSettings(){
 	// Cleanup
 }
 
-void ofxBezierEditorSettings::loadPointsJson(ofJson pntsJson){
-	// Read data from JSON
-	JSONBezier = pntsJson;
-	bUseRibbonMesh = JSONBezier["bezier"]["useRibbonMesh"].get <bool>();
-	ofLogVerbose("ofxBezierEditor") << "bUseRibbonMesh: " << bUseRibbonMesh;
-	ribbonWidth = JSONBezier["bezier"]["ribbonWidth"].get <float>();
-	ofLogVerbose("ofxBezierEditor") << "ribbonWidth: " << ribbonWidth;
-	meshLengthPrecisionMultiplier = JSONBezier["bezier"]["meshLengthPrecision"].get <int>();
-	ofLogVerbose("ofxBezierEditor") << "meshLengthPrecisionMultiplier: " << meshLengthPrecisionMultiplier;
+//--------------------------------------------------------------
+void ofxBezierEditorSettings::setTransform(const glm::vec2 & translation, float rotation, float scale){
+	transformTranslation = translation;
+	transformRotation = rotation;
+	transformScale = scale;
+}
+
+void ofxBezierEditorSettings::resetTransform(){
+	setTransform(glm::vec2(0, 0));
+	transformPivot = glm::vec2(0, 0);
+}
+
+bool ofxBezierEditorSettings::hasTransform() const {
+	return transformTranslation != glm::vec2(0, 0) || transformRotation != 0 || transformScale != 1;
+}
+
+glm::mat4 ofxBezierEditorSettings::getTransformMatrix() const {
+	glm::mat4 m(1);
+	m = glm::translate(m, glm::vec3(transformTranslation + transformPivot, 0));
+	m = glm::rotate(m, ofDegToRad(transformRotation), glm::vec3(0, 0, 1));
+	m = glm::scale(m, glm::vec3(transformScale, transformScale, 1));
+	m = glm::translate(m, glm::vec3(-transformPivot, 0));
+	return m;
+}
+
+glm::vec2 ofxBezierEditorSettings::toCurveCoordinates(const glm::vec2 & point) const {
+	if(!hasTransform()){
+		return point;
+	}
+	// inverse of fromCurveCoordinates, without going through a matrix inverse
+	glm::vec2 p = point - transformTranslation - transformPivot;
+	float angle = -ofDegToRad(transformRotation);
+	p = glm::vec2(p.x * cos(angle) - p.y * sin(angle), p.x * sin(angle) + p.y * cos(angle));
+	return p / transformScale + transformPivot;
+}
+
+glm::vec2 ofxBezierEditorSettings::fromCurveCoordinates(const glm::vec2 & point) const {
+	if(!hasTransform()){
+		return point;
+	}
+	glm::vec2 p = (point - transformPivot) * transformScale;
+	float angle = ofDegToRad(transformRotation);
+	p = glm::vec2(p.x * cos(angle) - p.y * sin(angle), p.x * sin(angle) + p.y * cos(angle));
+	return p + transformPivot + transformTranslation;
+}
 
-	bUseTubeMesh = JSONBezier["bezier"]["useTubeMesh"].get <bool>();
-	ofLogVerbose("ofxBezierEditor") << "bUseTubeMesh: " << bUseTubeMesh;
-	tubeRadius = JSONBezier["bezier"]["tubeRadius"].get <float>();
-	ofLogVerbose("ofxBezierEditor") << "tubeRadius: " << tubeRadius;
-	tubeResolution = JSONBezier["bezier"]["tubeResolution"].get <int>();
-	ofLogVerbose("ofxBezierEditor") << "tubeResolution: " << tubeResolution;
+ofRectangle ofxBezierEditorSettings::toCurveCoordinates(const ofRectangle & rect) const {
+	if(!hasTransform()){
+		return rect;
+	}
+	glm::vec2 corner = toCurveCoordinates(glm::vec2(rect.getMinX(), rect.getMinY()));
+	ofRectangle result(corner.x, corner.y, 0, 0);
+	result.growToInclude(toCurveCoordinates(glm::vec2(rect.getMaxX(), rect.getMinY())));
+	result.growToInclude(toCurveCoordinates(glm::vec2(rect.getMaxX(), rect.getMaxY())));
+	result.growToInclude(toCurveCoordinates(glm::vec2(rect.getMinX(), rect.getMaxY())));
+	return result;
+}
 
+void ofxBezierEditorSettings::bakeTransform(){
+	if(!hasTransform()){
+		return;
+	}
+	for(auto & v : curveVertices){
+		v.pos = fromCurveCoordinates(v.pos);
+	}
+	for(auto & v : controlPoint1){
+		v.pos = fromCurveCoordinates(v.pos);
+	}
+	for(auto & v : controlPoint2){
+		v.pos = fromCurveCoordinates(v.pos);
+	}
+	resetTransform();
+}
 
-	bIsClosed = JSONBezier["bezier"]["closed"].get <bool>();
-	ofLogVerbose("ofxBezierEditor") << "bIsClosed: " << bIsClosed;
+//--------------------------------------------------------------
+void ofxBezierEditorSettings::loadPointsJson(ofJson pntsJson){
+	// Read data from JSON
+	JSONBezier = pntsJson;
+	// the file holds baked points
+	resetTransform();
+	loadMeshSettingsJson(JSONBezier["bezier"]);
 
 	//polyLineFromPoints.setClosed(bIsClosed);
 
@@ -125,15 +186,7 @@ void ofxBezierEditorSettings::savePointsJson(){
 
 	// Create the JSON structure
 	JSONBezier["bezier"]["fill"] = bfillBezier;
-	JSONBezier["bezier"]["closed"] = bIsClosed;
-
-	JSONBezier["bezier"]["useRibbonMesh"] = bUseRibbonMesh;
-	JSONBezier["bezier"]["meshLengthPrecision"] = meshLengthPrecisionMultiplier;
-	JSONBezier["bezier"]["ribbonWidth"] = ribbonWidth;
-
-	JSONBezier["bezier"]["useTubeMesh"] = bUseTubeMesh;
-	JSONBezier["bezier"]["tubeRadius"] = tubeRadius;
-	JSONBezier["bezier"]["tubeResolution"] = tubeResolution;
+	saveMeshSettingsJson(JSONBezier["bezier"]);
 
 	JSONBezier["bezier"]["colorFill"]["r"] = colorFill.r;
 	JSONBezier["bezier"]["colorFill"]["g"] = colorFill.g;
@@ -145,19 +198,23 @@ void ofxBezierEditorSettings::savePointsJson(){
 	JSONBezier["bezier"]["colorStroke"]["b"] = colorStroke.b;
 	JSONBezier["bezier"]["colorStroke"]["a"] = colorStroke.a;
 
+	// points are saved with the transform baked in
 	for(int i = 0; i < curveVertices.size(); i++){
-		JSONBezier["bezier"]["vertices"][i]["x"] = curveVertices.at(i).pos.x;
-		JSONBezier["bezier"]["vertices"][i]["y"] = curveVertices.at(i).pos.y;
+		glm::vec2 pos = fromCurveCoordinates(curveVertices.at(i).pos);
+		JSONBezier["bezier"]["vertices"][i]["x"] = pos.x;
+		JSONBezier["bezier"]["vertices"][i]["y"] = pos.y;
 	}
 
 	for(int i = 0; i < controlPoint1.size(); i++){
-		JSONBezier["bezier"]["cp1"][i]["x"] = controlPoint1.at(i).pos.x;
-		JSONBezier["bezier"]["cp1"][i]["y"] = controlPoint1.at(i).pos.y;
+		glm::vec2 pos = fromCurveCoordinates(controlPoint1.at(i).pos);
+		JSONBezier["bezier"]["cp1"][i]["x"] = pos.x;
+		JSONBezier["bezier"]["cp1"][i]["y"] = pos.y;
 	}
 
 	for(int i = 0; i < controlPoint2.size(); i++){
-		JSONBezier["bezier"]["cp2"][i]["x"] = controlPoint2.at(i).pos.x;
-		JSONBezier["bezier"]["cp2"][i]["y"] = controlPoint2.at(i).pos.y;
+		glm::vec2 pos = fromCurveCoordinates(controlPoint2.at(i).pos);
+		JSONBezier["bezier"]["cp2"][i]["x"] = pos.x;
+		JSONBezier["bezier"]["cp2"][i]["y"] = pos.y;
 	}
 }
 //--------------------------------------------------------------
@@ -170,6 +227,6 @@ void ofxBezierEditorSettings::savePoints(string filename){
 }
 void ofxBezierEditorSettings::triggerUpdate(){
 	TriggerUpdateEventArgs args;
-	// Set any necessary properties of args
+	args.source = "loadPoints";
 	ofNotifyEvent(triggerUpdateEvent, args, this);
 }
@@ -9,67 +9,21 @@
 #include "ofMain.h"
 #include "draggableVertex.h"
 #include "ofxBezierEvents.h"
+#include "ofxBezierMeshSettings.h"
 
-class ofxBezierEditorSettings {
+class ofxBezierEditorSettings : public ofxBezierMeshSettings {
 	public:
 		ofxBezierEditorSettings(std::vector <draggableVertex> & curveVertices,
 								std::vector <draggableVertex> & controlPoint1,
 								std::vector <draggableVertex> & controlPoint2);
 		~ofxBezierEditorSettings();
 
-		bool getUseRibbonMesh(){
-			return bUseRibbonMesh;
-		}
-		void setUseRibbonMesh(bool b){
-			bUseRibbonMesh = b;
-		}
-		void setMeshLengthPrecisionMultiplier(int m){
-			meshLengthPrecisionMultiplier = m;
-		}
-		int getMeshLengthPrecisionMultiplier(){
-			return meshLengthPrecisionMultiplier;
-		}
-		float getRibbonWidth(){
-			return ribbonWidth;
-		}
-		void setRibbonWidth(float w){
-			ribbonWidth;
-		}
-
-
-		void setTubeResolution(int r){
-			tubeResolution = r;
-		}
-		int getTubeResolution(){
-			return tubeResolution;
-		}
-		void setTubeRadius(float r){
-			tubeRadius = r;
-		}
-		float getTubeRadius(){
-			return tubeRadius;
-		}
-
-		bool getHasRoundCaps(){
-			return roundCap;
-		}
-		void setHasRoundCaps(bool b){
-			roundCap = b;
-		}
-
 		bool getFillBezier(){
 			return bfillBezier;
 		}
 		void setFillBezier(bool b){
 			bfillBezier = b;
 		}
-		void setClosed(bool b){
-			bIsClosed = b;
-		}
-		bool getClosed(){
-			return bIsClosed;
-		}
-
 		int getRadiusControlPoints(){
 			return radiusControlPoints;
 		}
@@ -84,6 +38,31 @@ class ofxBezierEditorSettings {
 		}
 
 
+		bool getProgressiveRefinement(){
+			return bProgressiveRefinement;
+		}
+		void setProgressiveRefinement(bool b){
+			bProgressiveRefinement = b;
+		}
+		float getRefinementBudgetMillis(){
+			return refinementBudgetMillis;
+		}
+		void setRefinementBudgetMillis(float m){
+			refinementBudgetMillis = m;
+		}
+		int getRefinementSteps(){
+			return refinementSteps;
+		}
+		void setRefinementSteps(int s){
+			refinementSteps = std::max(s, 0);
+		}
+		float getRefinementIdleMillis(){
+			return refinementIdleMillis;
+		}
+		void setRefinementIdleMillis(float m){
+			refinementIdleMillis = m;
+		}
+
 		void setColorFill(ofColor c);
 //    void setColorFill(float r, float g, float b, float a = 255.0);
 //    void setColorFillR(float c);
@@ -107,6 +86,29 @@ class ofxBezierEditorSettings {
 
 
 
+		// Placement of the whole shape, applied when drawing. Points, polyline, meshes and bounds stay in
+		// curve coordinates until bakeTransform(), so moving, turning or scaling the shape rebuilds nothing.
+		// Rotation (degrees) and scale are around pivot, translation is applied last, in screen units.
+		void setTransform(const glm::vec2 & translation, float rotation = 0, float scale = 1);
+		void setTransformPivot(const glm::vec2 & pivot){
+			transformPivot = pivot;
+		}
+		void resetTransform();
+		bool hasTransform() const;
+		glm::mat4 getTransformMatrix() const;
+		// screen (or parent) coordinates to curve coordinates, and back
+		glm::vec2 toCurveCoordinates(const glm::vec2 & point) const;
+		glm::vec2 fromCurveCoordinates(const glm::vec2 & point) const;
+		// bounding box in curve coordinates of a rectangle in screen coordinates, e.g. a viewport
+		ofRectangle toCurveCoordinates(const ofRectangle & rect) const;
+		// Applies the transform to the points and resets it, the geometry then has to be rebuilt
+		void bakeTransform();
+
+		glm::vec2 transformTranslation = {0, 0};
+		float transformRotation = 0;
+		float transformScale = 1;
+		glm::vec2 transformPivot = {0, 0};
+
 		// File Operations
 		string jsonFileName;
 		void loadPoints(string filename);
@@ -137,16 +139,20 @@ class ofxBezierEditorSettings {
 		ofRectangle boundingBox;
 
 		bool beditBezier = false;
-		bool bIsClosed = false;
 		bool bfillBezier = false;
-		bool bUseRibbonMesh = false;
-		bool bUseTubeMesh = false;
 		bool bshowBoundingBox = false;
-		int meshLengthPrecisionMultiplier = 1;
-		float ribbonWidth = 10.0;
-		int tubeResolution = 10;
-		float tubeRadius = 10.0;
-		bool roundCap = true;
+		bool bShowProfilerOverlay = false;
+
+		// Progressive refinement: while a handle is dragged the meshes are built at the finest quality step
+		// expected to fit in refinementBudgetMillis, once input is idle they are refined up to full quality
+		bool bProgressiveRefinement = false;
+		float refinementBudgetMillis = 8;
+		// quality steps below full, each one halves the rings along the curve and around the tube
+		int refinementSteps = 3;
+		// input counts as idle this long after the last edit, even with the mouse button still down
+		float refinementIdleMillis = 100;
+		// set by the UI while a handle or the bounding box is being dragged
+		bool bInteracting = false;
 		int currentPointToMove = 0;
 		int lastVertexSelected = 0;
 
@@ -10,8 +10,11 @@
 #include "ofMain.h"
 
 class TriggerUpdateEventArgs : public ofEventArgs {
-	// Define any arguments you want to pass with the event
-	// For a simple trigger, you might not need to pass any data
+	public:
+		// What caused the update, shown in the profiler ("mouseDragged", "loadPoints"...)
+		std::string source = "event";
+		// input events folded into this update on top of the one that triggered it
+		int mergedEvents = 0;
 };
 
 extern ofEvent <TriggerUpdateEventArgs> triggerUpdateEvent;
@@ -0,0 +1,279 @@
+//
+//  ofxBezierHistory.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierHistory.h"
+
+namespace {
+	const char journalMagic[4] = { 'B', 'Z', 'J', '1' };
+
+	template <typename T>
+	void writeValue(std::ofstream & stream, const T & value){
+		stream.write(reinterpret_cast <const char *>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool readValue(std::ifstream & stream, T & value){
+		stream.read(reinterpret_cast <char *>(&value), sizeof(T));
+		return stream.gcount() == sizeof(T);
+	}
+
+	draggableVertex makeVertex(const glm::vec2 & pos){
+		draggableVertex vertex;
+		vertex.pos = pos;
+		return vertex;
+	}
+}
+
+ofxBezierHistory::ofxBezierHistory(){
+}
+
+ofxBezierHistory::~ofxBezierHistory(){
+	closeJournal();
+}
+
+bool ofxBezierHistory::record(const std::vector <draggableVertex> & curveVertices, const std::vector <draggableVertex> & controlPoint1,
+							  const std::vector <draggableVertex> & controlPoint2, bool closed, const std::string & label, bool mergeable){
+	fillPoints(curveVertices, controlPoint1, controlPoint2, current);
+
+	// the changed run is what is left between the common start and the common end
+	int before = baseline.size();
+	int after = current.size();
+	int prefix = 0;
+	while(prefix < before && prefix < after && baseline[prefix] == current[prefix]){
+		prefix++;
+	}
+	int suffix = 0;
+	while(suffix < before - prefix && suffix < after - prefix && baseline[before - 1 - suffix] == current[after - 1 - suffix]){
+		suffix++;
+	}
+	if(prefix == before && prefix == after && closed == baselineClosed){
+		return false;
+	}
+
+	redoEntries.clear();
+	Entry * entry = nullptr;
+	if(mergeable && bOpen && !undoEntries.empty()){
+		Entry & last = undoEntries.back();
+		// a drag keeps moving slots the open entry already covers, anything else is a new change
+		int end = last.start + last.inserted.size();
+		if(last.label == label && before == after && prefix >= last.start && before - suffix <= end){
+			entry = &last;
+			byteSize -= entry->getByteSize();
+			entry->inserted.assign(current.begin() + last.start, current.begin() + end);
+		}
+	}
+	if(entry == nullptr){
+		journalOpenEntry();
+		undoEntries.emplace_back();
+		entry = &undoEntries.back();
+		entry->label = label;
+		entry->start = prefix;
+		entry->removed.assign(baseline.begin() + prefix, baseline.end() - suffix);
+		entry->inserted.assign(current.begin() + prefix, current.end() - suffix);
+		entry->closedBefore = baselineClosed;
+	}
+	entry->closedAfter = closed;
+	byteSize += entry->getByteSize();
+	bOpen = mergeable;
+	if(!bOpen){
+		journalOpenEntry();
+	}
+
+	std::swap(baseline, current);
+	baselineClosed = closed;
+	trimToBudget();
+	return true;
+}
+
+void ofxBezierHistory::seal(){
+	if(bOpen){
+		journalOpenEntry();
+		bOpen = false;
+	}
+}
+
+void ofxBezierHistory::rebase(const std::vector <draggableVertex> & curveVertices, const std::vector <draggableVertex> & controlPoint1,
+							  const std::vector <draggableVertex> & controlPoint2, bool closed){
+	seal();
+	fillPoints(curveVertices, controlPoint1, controlPoint2, baseline);
+	baselineClosed = closed;
+}
+
+void ofxBezierHistory::fillPoints(const std::vector <draggableVertex> & curveVertices, const std::vector <draggableVertex> & controlPoint1,
+								  const std::vector <draggableVertex> & controlPoint2, std::vector <Point> & points){
+	points.resize(curveVertices.size());
+	for(int i = 0; i < curveVertices.size(); i++){
+		points[i].vertex = curveVertices[i].pos;
+		points[i].control1 = i < controlPoint1.size() ? controlPoint1[i].pos : glm::vec2(0, 0);
+		points[i].control2 = i < controlPoint2.size() ? controlPoint2[i].pos : glm::vec2(0, 0);
+	}
+}
+
+bool ofxBezierHistory::undo(std::vector <draggableVertex> & curveVertices, std::vector <draggableVertex> & controlPoint1,
+							std::vector <draggableVertex> & controlPoint2, bool & closed){
+	seal();
+	if(undoEntries.empty()){
+		return false;
+	}
+	Entry entry = std::move(undoEntries.back());
+	undoEntries.pop_back();
+	byteSize -= entry.getByteSize();
+	apply(entry.start, entry.inserted.size(), entry.removed, entry.closedBefore, curveVertices, controlPoint1, controlPoint2);
+	closed = entry.closedBefore;
+	redoEntries.push_back(std::move(entry));
+	return true;
+}
+
+bool ofxBezierHistory::redo(std::vector <draggableVertex> & curveVertices, std::vector <draggableVertex> & controlPoint1,
+							std::vector <draggableVertex> & controlPoint2, bool & closed){
+	seal();
+	if(redoEntries.empty()){
+		return false;
+	}
+	Entry entry = std::move(redoEntries.back());
+	redoEntries.pop_back();
+	byteSize += entry.getByteSize();
+	apply(entry.start, entry.removed.size(), entry.inserted, entry.closedAfter, curveVertices, controlPoint1, controlPoint2);
+	closed = entry.closedAfter;
+	undoEntries.push_back(std::move(entry));
+	trimToBudget();
+	return true;
+}
+
+std::string ofxBezierHistory::getUndoLabel() const {
+	return undoEntries.empty() ? "" : undoEntries.back().label;
+}
+
+std::string ofxBezierHistory::getRedoLabel() const {
+	return redoEntries.empty() ? "" : redoEntries.back().label;
+}
+
+void ofxBezierHistory::apply(int start, int count, const std::vector <Point> & points, bool closed,
+							 std::vector <draggableVertex> & curveVertices, std::vector <draggableVertex> & controlPoint1,
+							 std::vector <draggableVertex> & controlPoint2){
+	// slots that only moved are overwritten in place, the vectors only change length if the entry did
+	int common = std::min(count, (int)points.size());
+	for(int i = 0; i < common; i++){
+		curveVertices[start + i].pos = points[i].vertex;
+		controlPoint1[start + i].pos = points[i].control1;
+		controlPoint2[start + i].pos = points[i].control2;
+	}
+	if(count > common){
+		curveVertices.erase(curveVertices.begin() + start + common, curveVertices.begin() + start + count);
+		controlPoint1.erase(controlPoint1.begin() + start + common, controlPoint1.begin() + start + count);
+		controlPoint2.erase(controlPoint2.begin() + start + common, controlPoint2.begin() + start + count);
+	}
+	for(int i = common; i < points.size(); i++){
+		curveVertices.insert(curveVertices.begin() + start + i, makeVertex(points[i].vertex));
+		controlPoint1.insert(controlPoint1.begin() + start + i, makeVertex(points[i].control1));
+		controlPoint2.insert(controlPoint2.begin() + start + i, makeVertex(points[i].control2));
+	}
+
+	baseline.erase(baseline.begin() + start, baseline.begin() + start + count);
+	baseline.insert(baseline.begin() + start, points.begin(), points.end());
+	baselineClosed = closed;
+	writeJournal(start, count, points, closed);
+}
+
+void ofxBezierHistory::clear(){
+	seal();
+	undoEntries.clear();
+	redoEntries.clear();
+	byteSize = 0;
+}
+
+void ofxBezierHistory::setMemoryBudget(size_t bytes){
+	memoryBudget = bytes;
+	trimToBudget();
+}
+
+void ofxBezierHistory::trimToBudget(){
+	// the newest entry is always kept, whatever its size
+	while(byteSize > memoryBudget && undoEntries.size() > 1){
+		byteSize -= undoEntries.front().getByteSize();
+		undoEntries.pop_front();
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxBezierHistory::openJournal(const std::string & filename){
+	closeJournal();
+	// an open entry could still change after the points below are written
+	seal();
+	journal.open(ofToDataPath(filename), std::ios::binary | std::ios::trunc);
+	if(!journal.is_open()){
+		ofLogError("ofxBezierHistory") << "openJournal(): can't write " << filename;
+		return false;
+	}
+	journal.write(journalMagic, sizeof(journalMagic));
+	// the first record puts the current points in place
+	writeJournal(0, 0, baseline, baselineClosed);
+	for(auto & entry : undoEntries){
+		entry.bJournaled = true;
+	}
+	return true;
+}
+
+void ofxBezierHistory::closeJournal(){
+	if(journal.is_open()){
+		seal();
+		journal.close();
+	}
+}
+
+void ofxBezierHistory::journalOpenEntry(){
+	if(undoEntries.empty() || undoEntries.back().bJournaled){
+		return;
+	}
+	Entry & entry = undoEntries.back();
+	writeJournal(entry.start, entry.removed.size(), entry.inserted, entry.closedAfter);
+	entry.bJournaled = true;
+}
+
+void ofxBezierHistory::writeJournal(int start, int count, const std::vector <Point> & points, bool closed){
+	if(!journal.is_open()){
+		return;
+	}
+	// start, slots removed, slots inserted, closed, then the inserted points
+	writeValue(journal, (int32_t)start);
+	writeValue(journal, (int32_t)count);
+	writeValue(journal, (int32_t)points.size());
+	writeValue(journal, (uint8_t)closed);
+	journal.write(reinterpret_cast <const char *>(points.data()), points.size() * sizeof(Point));
+	journal.flush();
+}
+
+bool ofxBezierHistory::ReadJournal(const std::string & filename, std::vector <Point> & points, bool & closed){
+	std::ifstream stream(ofToDataPath(filename), std::ios::binary);
+	char magic[4];
+	stream.read(magic, sizeof(magic));
+	if(!stream || !std::equal(magic, magic + sizeof(magic), journalMagic)){
+		ofLogError("ofxBezierHistory") << "ReadJournal(): " << filename << " is not a journal";
+		return false;
+	}
+	points.clear();
+	closed = false;
+	std::vector <Point> inserted;
+	while(true){
+		int32_t start, count, size;
+		uint8_t recordClosed;
+		if(!readValue(stream, start) || !readValue(stream, count) || !readValue(stream, size) || !readValue(stream, recordClosed)){
+			break;
+		}
+		if(start < 0 || count < 0 || size < 0 || start + count > points.size()){
+			ofLogWarning("ofxBezierHistory") << "ReadJournal(): " << filename << " has a broken record, stopping there";
+			break;
+		}
+		inserted.resize(size);
+		stream.read(reinterpret_cast <char *>(inserted.data()), size * sizeof(Point));
+		if(stream.gcount() != size * sizeof(Point)){
+			break;
+		}
+		points.erase(points.begin() + start, points.begin() + start + count);
+		points.insert(points.begin() + start, inserted.begin(), inserted.end());
+		closed = recordClosed != 0;
+	}
+	return true;
+}
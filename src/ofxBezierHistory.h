@@ -0,0 +1,127 @@
+//
+//  ofxBezierHistory.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "draggableVertex.h"
+
+// Undo and redo for the points of an editor. Every change is stored as the run of vertex slots
+// (vertex and both handles) it replaced and what replaced it, found by comparing the points with
+// the last recorded state, so moving one handle of a long path costs a few dozen bytes. Changes
+// marked mergeable with the same label are folded into the open entry until seal(), which is how
+// a whole drag becomes one undo step. The oldest entries are dropped once the history grows past
+// its memory budget.
+// With a journal open every entry is also appended to a small binary file as it is sealed, so the
+// points can be recovered with ReadJournal() after a crash.
+class ofxBezierHistory {
+	public:
+		struct Point {
+			glm::vec2 vertex;
+			glm::vec2 control1;
+			glm::vec2 control2;
+
+			bool operator==(const Point & other) const {
+				return vertex == other.vertex && control1 == other.control1 && control2 == other.control2;
+			}
+			bool operator!=(const Point & other) const {
+				return !(*this == other);
+			}
+		};
+
+		ofxBezierHistory();
+		~ofxBezierHistory();
+
+		// Records how the points differ from the last call, returns false if nothing changed
+		bool record(const std::vector <draggableVertex> & curveVertices, const std::vector <draggableVertex> & controlPoint1,
+					const std::vector <draggableVertex> & controlPoint2, bool closed, const std::string & label, bool mergeable = false);
+		// The next change starts a new entry
+		void seal();
+		// Takes the points as they are without an entry, for changes that shouldn't be undone (animation)
+		void rebase(const std::vector <draggableVertex> & curveVertices, const std::vector <draggableVertex> & controlPoint1,
+					const std::vector <draggableVertex> & controlPoint2, bool closed);
+
+		// Apply the last undone or done entry to the points, false if there is nothing to do
+		bool undo(std::vector <draggableVertex> & curveVertices, std::vector <draggableVertex> & controlPoint1,
+				  std::vector <draggableVertex> & controlPoint2, bool & closed);
+		bool redo(std::vector <draggableVertex> & curveVertices, std::vector <draggableVertex> & controlPoint1,
+				  std::vector <draggableVertex> & controlPoint2, bool & closed);
+		bool canUndo() const {
+			return !undoEntries.empty();
+		}
+		bool canRedo() const {
+			return !redoEntries.empty();
+		}
+		size_t getUndoCount() const {
+			return undoEntries.size();
+		}
+		size_t getRedoCount() const {
+			return redoEntries.size();
+		}
+		// label of the entry undo() would apply, empty if there is none
+		std::string getUndoLabel() const;
+		std::string getRedoLabel() const;
+
+		// Forgets every entry, the current points stay the starting point for the next one
+		void clear();
+
+		void setMemoryBudget(size_t bytes);
+		size_t getMemoryBudget() const {
+			return memoryBudget;
+		}
+		// bytes held by the undo entries
+		size_t getByteSize() const {
+			return byteSize;
+		}
+
+		// Starts a journal with the current points, replacing the file
+		bool openJournal(const std::string & filename);
+		void closeJournal();
+		bool isJournalOpen() const {
+			return journal.is_open();
+		}
+		// Replays a journal, a record cut short by a crash is ignored. False if the file can't be read.
+		static bool ReadJournal(const std::string & filename, std::vector <Point> & points, bool & closed);
+
+	private:
+		// slots start to start + removed.size() were replaced by inserted
+		struct Entry {
+			std::string label;
+			int start = 0;
+			std::vector <Point> removed;
+			std::vector <Point> inserted;
+			bool closedBefore = false;
+			bool closedAfter = false;
+			bool bJournaled = false;
+
+			size_t getByteSize() const {
+				return sizeof(Entry) + label.capacity() + (removed.capacity() + inserted.capacity()) * sizeof(Point);
+			}
+		};
+
+		// replaces count slots at start with points, in the editor's vectors and in the baseline
+		void apply(int start, int count, const std::vector <Point> & points, bool closed,
+				   std::vector <draggableVertex> & curveVertices, std::vector <draggableVertex> & controlPoint1,
+				   std::vector <draggableVertex> & controlPoint2);
+		void writeJournal(int start, int count, const std::vector <Point> & points, bool closed);
+		void journalOpenEntry();
+		void trimToBudget();
+		void fillPoints(const std::vector <draggableVertex> & curveVertices, const std::vector <draggableVertex> & controlPoint1,
+						const std::vector <draggableVertex> & controlPoint2, std::vector <Point> & points);
+
+		std::deque <Entry> undoEntries;
+		std::vector <Entry> redoEntries;
+		// whether the last undo entry can still take merged changes
+		bool bOpen = false;
+		size_t byteSize = 0;
+		size_t memoryBudget = 4 * 1024 * 1024;
+
+		// the points as of the last record, undo or redo
+		std::vector <Point> baseline;
+		bool baselineClosed = false;
+		std::vector <Point> current;
+
+		std::ofstream journal;
+};
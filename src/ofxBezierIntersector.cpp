@@ -0,0 +1,579 @@
+//
+//  ofxBezierIntersector.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierIntersector.h"
+#include "ofxBezierUtility.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+	// a piece of a segment, between t0 and t1 of the original
+	struct Piece {
+		glm::vec2 p[4];
+		float t0 = 0;
+		float t1 = 1;
+	};
+
+	struct Box {
+		glm::vec2 min;
+		glm::vec2 max;
+	};
+
+	const int maxDepth = 40;
+	// coincident curves overlap everywhere, stop reporting after this many hits per segment pair
+	const int maxHitsPerPair = 32;
+	// hits closer than this many tolerances are the same crossing
+	const float mergeDistance = 4.0;
+
+	Piece makePiece(const ofxBezierSegmentTree::Segment & segment){
+		Piece piece;
+		piece.p[0] = segment.p0;
+		piece.p[1] = segment.c1;
+		piece.p[2] = segment.c2;
+		piece.p[3] = segment.p1;
+		return piece;
+	}
+
+	// the curve lies inside the box of its control points
+	Box getBox(const Piece & piece){
+		Box box;
+		box.min = glm::min(glm::min(piece.p[0], piece.p[1]), glm::min(piece.p[2], piece.p[3]));
+		box.max = glm::max(glm::max(piece.p[0], piece.p[1]), glm::max(piece.p[2], piece.p[3]));
+		return box;
+	}
+
+	bool overlaps(const Box & a, const Box & b){
+		return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y;
+	}
+
+	bool overlaps(const ofRectangle & a, const ofRectangle & b){
+		return a.getMinX() <= b.getMaxX() && a.getMaxX() >= b.getMinX() && a.getMinY() <= b.getMaxY() && a.getMaxY() >= b.getMinY();
+	}
+
+	// how far the control points stray from the chord, the curve is within 3/4 of that
+	bool isFlat(const Piece & piece, float tolerance){
+		glm::vec2 chord = piece.p[3] - piece.p[0];
+		float length = glm::length(chord);
+		if(length < tolerance){
+			return glm::distance(piece.p[1], piece.p[0]) < tolerance && glm::distance(piece.p[2], piece.p[0]) < tolerance;
+		}
+		glm::vec2 normal(-chord.y / length, chord.x / length);
+		float d1 = fabs(glm::dot(piece.p[1] - piece.p[0], normal));
+		float d2 = fabs(glm::dot(piece.p[2] - piece.p[0], normal));
+		return std::max(d1, d2) * 0.75 < tolerance;
+	}
+
+	enum ChordResult {
+		CHORDS_MISS,
+		CHORDS_CROSS,
+		CHORDS_PARALLEL
+	};
+
+	// where the chords of two flat pieces cross, as fractions along each chord
+	ChordResult intersectChords(const Piece & a, const Piece & b, float & u, float & v){
+		glm::vec2 da = a.p[3] - a.p[0];
+		glm::vec2 db = b.p[3] - b.p[0];
+		float denominator = da.x * db.y - da.y * db.x;
+		if(fabs(denominator) < 1e-12){
+			return CHORDS_PARALLEL;
+		}
+		glm::vec2 offset = b.p[0] - a.p[0];
+		u = (offset.x * db.y - offset.y * db.x) / denominator;
+		v = (offset.x * da.y - offset.y * da.x) / denominator;
+		return (u >= 0 && u <= 1 && v >= 0 && v <= 1) ? CHORDS_CROSS : CHORDS_MISS;
+	}
+
+	// the chord is not parameterised like the curve, so the curve parameter of a point on it
+	// comes from projecting the point back onto the piece
+	float getPieceT(const Piece & piece, const glm::vec2 & point){
+		float t;
+		ofxBezierUtility::ClosestPointOnSegment(piece.p[0], piece.p[1], piece.p[2], piece.p[3], point, t);
+		return ofLerp(piece.t0, piece.t1, t);
+	}
+
+	float getSize(const Box & box){
+		return std::max(box.max.x - box.min.x, box.max.y - box.min.y);
+	}
+
+	// de Casteljau at 0.5
+	void split(const Piece & piece, Piece & left, Piece & right){
+		glm::vec2 q0 = (piece.p[0] + piece.p[1]) * 0.5f;
+		glm::vec2 q1 = (piece.p[1] + piece.p[2]) * 0.5f;
+		glm::vec2 q2 = (piece.p[2] + piece.p[3]) * 0.5f;
+		glm::vec2 r0 = (q0 + q1) * 0.5f;
+		glm::vec2 r1 = (q1 + q2) * 0.5f;
+		glm::vec2 s = (r0 + r1) * 0.5f;
+		float tMid = (piece.t0 + piece.t1) * 0.5f;
+
+		left.p[0] = piece.p[0];
+		left.p[1] = q0;
+		left.p[2] = r0;
+		left.p[3] = s;
+		left.t0 = piece.t0;
+		left.t1 = tMid;
+
+		right.p[0] = s;
+		right.p[1] = r1;
+		right.p[2] = q2;
+		right.p[3] = piece.p[3];
+		right.t0 = tMid;
+		right.t1 = piece.t1;
+	}
+
+	struct PieceHit {
+		float tA;
+		float tB;
+		glm::vec2 point;
+	};
+
+	void addPieceHit(std::vector <PieceHit> & hits, float tA, float tB, const glm::vec2 & point, float tolerance){
+		for(const auto & hit : hits){
+			if(glm::distance(hit.point, point) < tolerance * mergeDistance){
+				return;
+			}
+		}
+		hits.push_back({ tA, tB, point });
+	}
+
+	void intersectPieces(const Piece & a, const Piece & b, float tolerance, int depth, std::vector <PieceHit> & hits){
+		if(hits.size() >= maxHitsPerPair){
+			return;
+		}
+		Box boxA = getBox(a);
+		Box boxB = getBox(b);
+		if(!overlaps(boxA, boxB)){
+			return;
+		}
+		// once both are as good as straight the chords give the crossing directly,
+		// only parallel chords (overlapping curves) need more subdivision
+		if(isFlat(a, tolerance) && isFlat(b, tolerance)){
+			float u, v;
+			ChordResult result = intersectChords(a, b, u, v);
+			if(result == CHORDS_CROSS){
+				glm::vec2 point = glm::mix(a.p[0], a.p[3], u);
+				addPieceHit(hits, getPieceT(a, point), getPieceT(b, point), point, tolerance);
+			}
+			if(result != CHORDS_PARALLEL){
+				return;
+			}
+		}
+		float sizeA = getSize(boxA);
+		float sizeB = getSize(boxB);
+		if((sizeA < tolerance && sizeB < tolerance) || depth >= maxDepth){
+			glm::vec2 point = ((boxA.min + boxA.max) * 0.5f + (boxB.min + boxB.max) * 0.5f) * 0.5f;
+			addPieceHit(hits, (a.t0 + a.t1) * 0.5f, (b.t0 + b.t1) * 0.5f, point, tolerance);
+			return;
+		}
+		// always split the bigger one, so both shrink at the same rate
+		Piece left, right;
+		if(sizeA >= sizeB){
+			split(a, left, right);
+			intersectPieces(left, b, tolerance, depth + 1, hits);
+			intersectPieces(right, b, tolerance, depth + 1, hits);
+		}else{
+			split(b, left, right);
+			intersectPieces(a, left, tolerance, depth + 1, hits);
+			intersectPieces(a, right, tolerance, depth + 1, hits);
+		}
+	}
+
+	// the tangent of a cubic stays inside the cone of its control polygon's edges,
+	// so it can only loop if the polygon turns by more than half a turn
+	bool canLoop(const Piece & piece){
+		float turning = 0;
+		for(int i = 0; i < 2; i++){
+			glm::vec2 edge1 = piece.p[i + 1] - piece.p[i];
+			glm::vec2 edge2 = piece.p[i + 2] - piece.p[i + 1];
+			if(glm::length2(edge1) == 0 || glm::length2(edge2) == 0){
+				continue;
+			}
+			turning += fabs(atan2(edge1.x * edge2.y - edge1.y * edge2.x, glm::dot(edge1, edge2)));
+		}
+		return turning > PI;
+	}
+
+	// loops inside a single segment: split it and intersect the halves with each other
+	void selfIntersectPiece(const Piece & piece, float tolerance, int depth, std::vector <PieceHit> & hits){
+		if(depth >= 8 || !canLoop(piece)){
+			return;
+		}
+		Piece left, right;
+		split(piece, left, right);
+
+		std::vector <PieceHit> halfHits;
+		intersectPieces(left, right, tolerance, 0, halfHits);
+		for(const auto & hit : halfHits){
+			// the halves always touch where they were split
+			if(glm::distance(hit.point, left.p[3]) > tolerance * mergeDistance){
+				addPieceHit(hits, hit.tA, hit.tB, hit.point, tolerance);
+			}
+		}
+		selfIntersectPiece(left, tolerance, depth + 1, hits);
+		selfIntersectPiece(right, tolerance, depth + 1, hits);
+	}
+
+	void intersectSegments(const ofxBezierSegmentTree & a, int segmentA, const ofxBezierSegmentTree & b, int segmentB,
+						   float tolerance, int curveA, int curveB, const glm::vec2 * sharedVertex, std::vector <ofxBezierIntersector::Hit> & hits){
+		std::vector <PieceHit> pieceHits;
+		intersectPieces(makePiece(a.getSegments()[segmentA]), makePiece(b.getSegments()[segmentB]), tolerance, 0, pieceHits);
+		for(const auto & pieceHit : pieceHits){
+			if(sharedVertex != nullptr && glm::distance(pieceHit.point, *sharedVertex) < tolerance * mergeDistance){
+				continue;
+			}
+			ofxBezierIntersector::Hit hit;
+			hit.curveA = curveA;
+			hit.segmentA = segmentA;
+			hit.tA = pieceHit.tA;
+			hit.curveB = curveB;
+			hit.segmentB = segmentB;
+			hit.tB = pieceHit.tB;
+			hit.point = pieceHit.point;
+			hits.push_back(hit);
+		}
+	}
+
+	void intersectRayPiece(const Piece & local, float tolerance, float maxDistance, int depth, std::vector <PieceHit> & hits){
+		if(hits.size() >= maxHitsPerPair){
+			return;
+		}
+		// in the ray's frame the ray is the positive x axis
+		Box box = getBox(local);
+		if(box.min.y > 0 || box.max.y < 0 || box.max.x < 0 || box.min.x > maxDistance){
+			return;
+		}
+		bool bFlat = isFlat(local, tolerance);
+		if(bFlat && fabs(local.p[0].y) < tolerance && fabs(local.p[3].y) < tolerance){
+			// lying along the ray, one hit where it comes into the ray's range instead of one per leaf
+			glm::vec2 point(std::max(std::min(local.p[0].x, local.p[3].x), 0.0f), 0);
+			if(point.x <= maxDistance){
+				addPieceHit(hits, getPieceT(local, point), point.x, point, tolerance);
+			}
+			return;
+		}
+		if(bFlat && local.p[0].y != local.p[3].y){
+			float u = local.p[0].y / (local.p[0].y - local.p[3].y);
+			glm::vec2 point(ofLerp(local.p[0].x, local.p[3].x, u), 0);
+			if(u >= 0 && u <= 1 && point.x >= 0 && point.x <= maxDistance){
+				addPieceHit(hits, getPieceT(local, point), point.x, point, tolerance);
+			}
+			return;
+		}
+		if(getSize(box) < tolerance || depth >= maxDepth){
+			float t = (local.t0 + local.t1) * 0.5f;
+			glm::vec2 point((box.min.x + box.max.x) * 0.5f, 0);
+			addPieceHit(hits, t, point.x, point, tolerance);
+			return;
+		}
+		Piece left, right;
+		split(local, left, right);
+		intersectRayPiece(left, tolerance, maxDistance, depth + 1, hits);
+		intersectRayPiece(right, tolerance, maxDistance, depth + 1, hits);
+	}
+
+	// slab test
+	bool rayHitsBox(const glm::vec2 & origin, const glm::vec2 & direction, float maxDistance, const ofRectangle & box){
+		float tMin = 0;
+		float tMax = maxDistance;
+		for(int axis = 0; axis < 2; axis++){
+			float minimum = axis == 0 ? box.getMinX() : box.getMinY();
+			float maximum = axis == 0 ? box.getMaxX() : box.getMaxY();
+			if(fabs(direction[axis]) < 1e-9){
+				if(origin[axis] < minimum || origin[axis] > maximum){
+					return false;
+				}
+				continue;
+			}
+			float t1 = (minimum - origin[axis]) / direction[axis];
+			float t2 = (maximum - origin[axis]) / direction[axis];
+			tMin = std::max(tMin, std::min(t1, t2));
+			tMax = std::min(tMax, std::max(t1, t2));
+			if(tMin > tMax){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// a closed curve's last segment ends where the first one starts
+	bool isLoop(const std::vector <ofxBezierSegmentTree::Segment> & segments){
+		return segments.size() > 2 && segments.back().p1 == segments.front().p0;
+	}
+
+	// the same segment, or two that share a vertex
+	bool areNeighbours(int i, int j, int segmentCount, bool loop){
+		int gap = std::abs(i - j);
+		return gap <= 1 || (loop && gap == segmentCount - 1);
+	}
+
+	// A crossing through a vertex is found on the segments either side of it, at t 1 on one and t 0 on
+	// the next. Hits on neighbouring segments closer than the merge distance are one crossing, the
+	// first one found is kept.
+	void mergeVertexHits(const ofxBezierSegmentTree & a, const ofxBezierSegmentTree & b, float tolerance, size_t firstHit, std::vector <ofxBezierIntersector::Hit> & hits){
+		int countA = a.getSegments().size();
+		int countB = b.getSegments().size();
+		bool loopA = isLoop(a.getSegments());
+		bool loopB = isLoop(b.getSegments());
+		size_t kept = firstHit;
+		for(size_t i = firstHit; i < hits.size(); i++){
+			bool bDuplicate = false;
+			for(size_t j = firstHit; j < kept && !bDuplicate; j++){
+				bDuplicate = areNeighbours(hits[i].segmentA, hits[j].segmentA, countA, loopA) &&
+							 areNeighbours(hits[i].segmentB, hits[j].segmentB, countB, loopB) &&
+							 glm::distance(hits[i].point, hits[j].point) < tolerance * mergeDistance;
+			}
+			if(!bDuplicate){
+				hits[kept++] = hits[i];
+			}
+		}
+		hits.resize(kept);
+	}
+
+	bool hitOrder(const ofxBezierIntersector::Hit & a, const ofxBezierIntersector::Hit & b){
+		if(a.curveA != b.curveA){
+			return a.curveA < b.curveA;
+		}
+		if(a.curveB != b.curveB){
+			return a.curveB < b.curveB;
+		}
+		if(a.segmentA != b.segmentA){
+			return a.segmentA < b.segmentA;
+		}
+		return a.tA < b.tA;
+	}
+}
+
+void ofxBezierIntersector::Intersect(const ofxBezierSegmentTree & a, const ofxBezierSegmentTree & b, std::vector <Hit> & hits, float tolerance, int curveA, int curveB){
+	const auto & nodesA = a.getNodes();
+	const auto & nodesB = b.getNodes();
+	if(nodesA.empty() || nodesB.empty()){
+		return;
+	}
+	size_t firstHit = hits.size();
+
+	// walk both trees at once, always opening the bigger node of an overlapping pair
+	std::vector <std::pair <int, int> > stack;
+	stack.push_back(std::make_pair(0, 0));
+	while(!stack.empty()){
+		std::pair <int, int> pair = stack.back();
+		stack.pop_back();
+		const ofxBezierSegmentTree::Node & nodeA = nodesA[pair.first];
+		const ofxBezierSegmentTree::Node & nodeB = nodesB[pair.second];
+		if(!overlaps(nodeA.bounds, nodeB.bounds)){
+			continue;
+		}
+		if(nodeA.isLeaf() && nodeB.isLeaf()){
+			for(int i = nodeA.first; i < nodeA.first + nodeA.count; i++){
+				for(int j = nodeB.first; j < nodeB.first + nodeB.count; j++){
+					if(overlaps(a.getSegments()[i].bounds, b.getSegments()[j].bounds)){
+						intersectSegments(a, i, b, j, tolerance, curveA, curveB, nullptr, hits);
+					}
+				}
+			}
+		}else if(nodeB.isLeaf() || (!nodeA.isLeaf() && nodeA.bounds.getArea() >= nodeB.bounds.getArea())){
+			stack.push_back(std::make_pair(nodeA.left, pair.second));
+			stack.push_back(std::make_pair(nodeA.right, pair.second));
+		}else{
+			stack.push_back(std::make_pair(pair.first, nodeB.left));
+			stack.push_back(std::make_pair(pair.first, nodeB.right));
+		}
+	}
+	mergeVertexHits(a, b, tolerance, firstHit, hits);
+}
+
+void ofxBezierIntersector::SelfIntersect(const ofxBezierSegmentTree & tree, std::vector <Hit> & hits, float tolerance, int curve){
+	const auto & segments = tree.getSegments();
+	const auto & nodes = tree.getNodes();
+	if(segments.empty()){
+		return;
+	}
+	size_t firstHit = hits.size();
+	bool wraps = isLoop(segments);
+
+	std::vector <int> leaves;
+	for(int node = 0; node < nodes.size(); node++){
+		if(!nodes[node].isLeaf()){
+			continue;
+		}
+		const ofxBezierSegmentTree::Node & leaf = nodes[node];
+		leaves.clear();
+		tree.queryLeaves(leaf.bounds, leaves);
+		for(int other : leaves){
+			const ofxBezierSegmentTree::Node & otherLeaf = nodes[other];
+			if(otherLeaf.first + otherLeaf.count <= leaf.first){
+				continue;
+			}
+			for(int i = leaf.first; i < leaf.first + leaf.count; i++){
+				for(int j = std::max(i + 1, otherLeaf.first); j < otherLeaf.first + otherLeaf.count; j++){
+					if(!overlaps(segments[i].bounds, segments[j].bounds)){
+						continue;
+					}
+					const glm::vec2 * sharedVertex = nullptr;
+					if(j == i + 1){
+						sharedVertex = &segments[i].p1;
+					}else if(wraps && i == 0 && j == segments.size() - 1){
+						sharedVertex = &segments[i].p0;
+					}
+					intersectSegments(tree, i, tree, j, tolerance, curve, curve, sharedVertex, hits);
+				}
+			}
+		}
+	}
+
+	for(int i = 0; i < segments.size(); i++){
+		std::vector <PieceHit> pieceHits;
+		selfIntersectPiece(makePiece(segments[i]), tolerance, 0, pieceHits);
+		for(const auto & pieceHit : pieceHits){
+			Hit hit;
+			hit.curveA = curve;
+			hit.segmentA = i;
+			hit.tA = pieceHit.tA;
+			hit.curveB = curve;
+			hit.segmentB = i;
+			hit.tB = pieceHit.tB;
+			hit.point = pieceHit.point;
+			hits.push_back(hit);
+		}
+	}
+	mergeVertexHits(tree, tree, tolerance, firstHit, hits);
+}
+
+void ofxBezierIntersector::Raycast(const ofxBezierSegmentTree & tree, const glm::vec2 & origin, const glm::vec2 & direction, std::vector <RayHit> & hits,
+								   float tolerance, float maxDistance){
+	float length = glm::length(direction);
+	if(length == 0 || tree.empty()){
+		return;
+	}
+	glm::vec2 axis = direction / length;
+	size_t firstHit = hits.size();
+
+	const auto & nodes = tree.getNodes();
+	std::vector <int> stack;
+	stack.push_back(0);
+	while(!stack.empty()){
+		const ofxBezierSegmentTree::Node & node = nodes[stack.back()];
+		stack.pop_back();
+		if(!rayHitsBox(origin, axis, maxDistance, node.bounds)){
+			continue;
+		}
+		if(!node.isLeaf()){
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+			continue;
+		}
+		for(int i = node.first; i < node.first + node.count; i++){
+			const ofxBezierSegmentTree::Segment & segment = tree.getSegments()[i];
+			if(!rayHitsBox(origin, axis, maxDistance, segment.bounds)){
+				continue;
+			}
+			// move the segment into the ray's frame
+			Piece local = makePiece(segment);
+			for(auto & p : local.p){
+				glm::vec2 offset = p - origin;
+				p = glm::vec2(glm::dot(offset, axis), axis.x * offset.y - axis.y * offset.x);
+			}
+			std::vector <PieceHit> pieceHits;
+			intersectRayPiece(local, tolerance, maxDistance, 0, pieceHits);
+			for(const auto & pieceHit : pieceHits){
+				RayHit hit;
+				hit.segment = i;
+				hit.t = pieceHit.tA;
+				hit.distance = pieceHit.point.x;
+				hit.point = origin + axis * hit.distance;
+				hits.push_back(hit);
+			}
+		}
+	}
+	std::sort(hits.begin() + firstHit, hits.end(), [](const RayHit & a, const RayHit & b){
+		return a.distance < b.distance;
+	});
+
+	// a ray through a vertex hits the segments either side of it, keep the nearer hit
+	int segmentCount = tree.getSegments().size();
+	bool loop = isLoop(tree.getSegments());
+	size_t kept = firstHit;
+	for(size_t i = firstHit; i < hits.size(); i++){
+		bool bDuplicate = false;
+		for(size_t j = firstHit; j < kept && !bDuplicate; j++){
+			bDuplicate = areNeighbours(hits[i].segment, hits[j].segment, segmentCount, loop) &&
+						 hits[i].distance - hits[j].distance < tolerance * mergeDistance;
+		}
+		if(!bDuplicate){
+			hits[kept++] = hits[i];
+		}
+	}
+	hits.resize(kept);
+}
+
+void ofxBezierIntersector::IntersectAll(const std::vector <const ofxBezierSegmentTree *> & trees, std::vector <Hit> & hits,
+										float tolerance, bool selfIntersections, int threadCount){
+	// sweep over x: sort the curves by the left edge of their bounds and only pair up
+	// curves whose x ranges are open at the same time
+	std::vector <int> order;
+	for(int i = 0; i < trees.size(); i++){
+		if(trees[i] != nullptr && !trees[i]->empty()){
+			order.push_back(i);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&trees](int a, int b){
+		return trees[a]->getBounds().getMinX() < trees[b]->getBounds().getMinX();
+	});
+
+	// a task with the same curve twice is a self intersection test
+	std::vector <std::pair <int, int> > tasks;
+	std::vector <int> active;
+	for(int index : order){
+		ofRectangle bounds = trees[index]->getBounds();
+		active.erase(std::remove_if(active.begin(), active.end(), [&](int other){
+			return trees[other]->getBounds().getMaxX() < bounds.getMinX();
+		}), active.end());
+		for(int other : active){
+			if(overlaps(trees[other]->getBounds(), bounds)){
+				tasks.push_back(std::make_pair(std::min(index, other), std::max(index, other)));
+			}
+		}
+		active.push_back(index);
+		if(selfIntersections){
+			tasks.push_back(std::make_pair(index, index));
+		}
+	}
+	if(tasks.empty()){
+		return;
+	}
+
+	if(threadCount <= 0){
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threadCount = std::min(threadCount, (int)tasks.size());
+
+	// the workers take tasks off a shared counter and keep their own hits until the end
+	std::atomic <size_t> nextTask(0);
+	std::vector <std::vector <Hit> > threadHits(threadCount);
+	auto work = [&](int thread){
+		size_t task;
+		while((task = nextTask++) < tasks.size()){
+			int a = tasks[task].first;
+			int b = tasks[task].second;
+			if(a == b){
+				SelfIntersect(*trees[a], threadHits[thread], tolerance, a);
+			}else{
+				Intersect(*trees[a], *trees[b], threadHits[thread], tolerance, a, b);
+			}
+		}
+	};
+	std::vector <std::thread> threads;
+	for(int i = 1; i < threadCount; i++){
+		threads.push_back(std::thread(work, i));
+	}
+	work(0);
+	for(auto & thread : threads){
+		thread.join();
+	}
+
+	size_t firstHit = hits.size();
+	for(const auto & threadHit : threadHits){
+		hits.insert(hits.end(), threadHit.begin(), threadHit.end());
+	}
+	std::sort(hits.begin() + firstHit, hits.end(), hitOrder);
+}
@@ -0,0 +1,58 @@
+//
+//  ofxBezierIntersector.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxBezierSegmentTree.h"
+
+// Intersections between the cubic segments of curves, straight from the control points.
+// The segment trees are the broad phase: only pairs of segments whose bounds overlap are
+// looked at. The narrow phase subdivides both cubics until their control boxes are smaller
+// than the tolerance, so hits are found to within tolerance in curve units.
+class ofxBezierIntersector {
+	public:
+		// t is the parameter along the segment, 0 at its start vertex and 1 at its end vertex
+		struct Hit {
+			int curveA = 0;
+			int segmentA = -1;
+			float tA = 0;
+			int curveB = 0;
+			int segmentB = -1;
+			float tB = 0;
+			glm::vec2 point;
+		};
+
+		struct RayHit {
+			int segment = -1;
+			float t = 0;
+			// from the origin along the ray
+			float distance = 0;
+			glm::vec2 point;
+		};
+
+		// Crossings of two curves. curveA and curveB are only copied into the hits. A crossing through a
+		// vertex is reported once, on one of the two segments that meet there.
+		static void Intersect(const ofxBezierSegmentTree & a, const ofxBezierSegmentTree & b, std::vector <Hit> & hits,
+							  float tolerance = 0.01, int curveA = 0, int curveB = 1);
+
+		// Places where a curve crosses itself, including loops inside a single segment.
+		// Neighbouring segments touching at their shared vertex do not count.
+		static void SelfIntersect(const ofxBezierSegmentTree & tree, std::vector <Hit> & hits, float tolerance = 0.01, int curve = 0);
+
+		// Every crossing of the ray with the curve, sorted by distance
+		static void Raycast(const ofxBezierSegmentTree & tree, const glm::vec2 & origin, const glm::vec2 & direction, std::vector <RayHit> & hits,
+							float tolerance = 0.01, float maxDistance = std::numeric_limits <float>::max());
+
+		// All crossings between any two of the curves (and within each curve if selfIntersections is set).
+		// Candidate pairs come from a sweep over the curves' bounds, the pairs are then split over
+		// threadCount threads, 0 uses one per core. The hits are sorted by curveA, curveB.
+		static void IntersectAll(const std::vector <const ofxBezierSegmentTree *> & trees, std::vector <Hit> & hits,
+								 float tolerance = 0.01, bool selfIntersections = false, int threadCount = 0);
+
+	private:
+		ofxBezierIntersector(){
+		}                 // Private constructor to prevent instantiation
+};
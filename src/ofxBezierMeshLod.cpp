@@ -0,0 +1,160 @@
+//
+//  ofxBezierMeshLod.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierMeshLod.h"
+#include "ofxBezierRibbonMeshBuilder.h"
+#include "ofxBezierTubeMeshBuilder.h"
+
+namespace {
+	// below this the tube stops looking round
+	const int minTubeResolution = 3;
+	// the builders need a few vertices to work out tangents
+	const int minPolylineVertices = 4;
+	// levels from here on get flat caps
+	const int flatCapLevel = 2;
+}
+
+ofxBezierMeshLod::ofxBezierMeshLod(){
+	setLevelCount(4);
+}
+
+ofxBezierMeshLod::~ofxBezierMeshLod(){
+}
+
+void ofxBezierMeshLod::setLevelCount(int count){
+	levels.clear();
+	levels.resize(std::max(count, 1));
+}
+
+void ofxBezierMeshLod::clear(){
+	for(auto & level : levels){
+		level.bBuilt = false;
+		level.ribbonMesh.clear();
+		level.tubeMesh.clear();
+	}
+	polyline.clear();
+	curveSize = 0;
+}
+
+void ofxBezierMeshLod::rebuild(const ofPolyline & line, const ofxBezierMeshSettings & settings){
+	clear();
+	polyline = line;
+	ofRectangle bounds = polyline.getBoundingBox();
+	curveSize = std::max(bounds.width, bounds.height);
+
+	for(int i = 0; i < levels.size(); i++){
+		Level & level = levels[i];
+		level.settings = settings;
+
+		// halve the rings by lowering the precision multiplier first, then by skipping polyline vertices
+		int divisor = 1 << i;
+		int multiplier = std::max(settings.meshLengthPrecisionMultiplier, 1);
+		level.settings.meshLengthPrecisionMultiplier = std::max(multiplier / divisor, 1);
+		level.stride = std::max(divisor / multiplier, 1);
+		while(level.stride > 1 && polyline.size() / level.stride < minPolylineVertices){
+			level.stride /= 2;
+		}
+
+		// arc length sampling ignores the multiplier, so the spacing grows instead
+		if(settings.bArcLengthSampling){
+			level.settings.sampleSpacing = settings.sampleSpacing * divisor;
+			level.stride = 1;
+		}
+
+		level.settings.tubeResolution = std::max(settings.tubeResolution >> i, std::min(settings.tubeResolution, minTubeResolution));
+		if(i >= flatCapLevel){
+			level.settings.roundCap = false;
+		}
+	}
+
+	// the coarsest level is cheap and can stand in for any other until that one is built
+	buildLevel(levels.size() - 1);
+}
+
+void ofxBezierMeshLod::buildLevel(int index){
+	Level & level = levels[index];
+	level.bBuilt = true;
+
+	ofPolyline line;
+	if(level.stride > 1){
+		const auto & vertices = polyline.getVertices();
+		for(int i = 0; i < vertices.size(); i += level.stride){
+			line.addVertex(vertices[i]);
+		}
+		// always keep the end point, closed lines end where they started
+		if((vertices.size() - 1) % level.stride != 0){
+			line.addVertex(vertices.back());
+		}
+		line.setClosed(polyline.isClosed());
+	}else{
+		line = polyline;
+	}
+
+	// same as ofxBezierCurve, the builders only live for the duration of the build
+	if(level.settings.bUseRibbonMesh){
+		ofxBezierRibbonMeshBuilder ribbonMeshBuilder(level.settings);
+		ribbonMeshBuilder.generateRibbonMeshFromPolyline(line);
+		ribbonMeshBuilder.moveRibbonMeshInto(level.ribbonMesh);
+	}
+	if(level.settings.bUseTubeMesh){
+		ofxBezierTubeMeshBuilder tubeMeshBuilder(level.settings);
+		tubeMeshBuilder.generateTubeMeshFromPolyline(line);
+		tubeMeshBuilder.moveTubeMeshInto(level.tubeMesh);
+	}
+}
+
+int ofxBezierMeshLod::getLevelForProjectedSize(float projectedSize) const {
+	if(projectedSize <= 0){
+		return levels.size() - 1;
+	}
+	// level 0 is meant for the curve drawn at its own size
+	float level = log2(curveSize / projectedSize) - bias;
+	return ofClamp(floor(level), 0, levels.size() - 1);
+}
+
+int ofxBezierMeshLod::getLevelForCameraDistance(float distance, float fovDegrees, float viewportHeight) const {
+	if(distance <= 0){
+		return 0;
+	}
+	float projectedSize = curveSize * viewportHeight / (2.0 * distance * tan(ofDegToRad(fovDegrees) * 0.5));
+	return getLevelForProjectedSize(projectedSize);
+}
+
+const ofVboMesh & ofxBezierMeshLod::getRibbonMesh(int level){
+	level = ofClamp(level, 0, levels.size() - 1);
+	if(!levels[level].bBuilt){
+		buildLevel(level);
+	}
+	return levels[level].ribbonMesh;
+}
+
+const ofVboMesh & ofxBezierMeshLod::getTubeMesh(int level){
+	level = ofClamp(level, 0, levels.size() - 1);
+	if(!levels[level].bBuilt){
+		buildLevel(level);
+	}
+	return levels[level].tubeMesh;
+}
+
+bool ofxBezierMeshLod::isLevelBuilt(int level) const {
+	if(level < 0 || level >= levels.size()){
+		return false;
+	}
+	return levels[level].bBuilt;
+}
+
+const ofxBezierMeshSettings & ofxBezierMeshLod::getLevelSettings(int level) const {
+	return levels[ofClamp(level, 0, levels.size() - 1)].settings;
+}
+
+int ofxBezierMeshLod::getBuiltLevelCount() const {
+	int count = 0;
+	for(const auto & level : levels){
+		if(level.bBuilt){
+			count++;
+		}
+	}
+	return count;
+}
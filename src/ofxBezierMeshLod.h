@@ -0,0 +1,68 @@
+//
+//  ofxBezierMeshLod.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxBezierMeshSettings.h"
+
+// A chain of ribbon and tube meshes of decreasing detail for the same polyline.
+// Level 0 is the full mesh, every level after it has half the rings and half the
+// radial segments of the one before, and the coarsest levels drop the round caps.
+// rebuild() only builds the coarsest level, finer levels are built the first time
+// they are asked for and kept until the next rebuild().
+class ofxBezierMeshLod {
+	public:
+		ofxBezierMeshLod();
+		~ofxBezierMeshLod();
+
+		void setLevelCount(int count);
+		int getLevelCount() const {
+			return levels.size();
+		}
+
+		// Each halving of the projected size drops one level, a positive bias keeps finer levels for longer
+		void setBias(float value){
+			bias = value;
+		}
+		float getBias() const {
+			return bias;
+		}
+
+		// Throws all levels away and builds the coarsest one
+		void rebuild(const ofPolyline & polyline, const ofxBezierMeshSettings & settings);
+		void clear();
+
+		// The level to draw when the curve's bounding box covers projectedSize pixels on screen
+		int getLevelForProjectedSize(float projectedSize) const;
+		// The same for a perspective camera at distance from the curve
+		int getLevelForCameraDistance(float distance, float fovDegrees, float viewportHeight) const;
+
+		const ofVboMesh & getRibbonMesh(int level);
+		const ofVboMesh & getTubeMesh(int level);
+		bool isLevelBuilt(int level) const;
+		const ofxBezierMeshSettings & getLevelSettings(int level) const;
+
+		// number of levels built since the last rebuild, used by the profiler
+		int getBuiltLevelCount() const;
+
+	private:
+		struct Level {
+			ofxBezierMeshSettings settings;
+			// only every stride-th polyline vertex is meshed
+			int stride = 1;
+			bool bBuilt = false;
+			ofVboMesh ribbonMesh;
+			ofVboMesh tubeMesh;
+		};
+
+		void buildLevel(int level);
+
+		std::vector <Level> levels;
+		ofPolyline polyline;
+		// size of the polyline's bounding box in its own units
+		float curveSize = 0;
+		float bias = 0;
+};
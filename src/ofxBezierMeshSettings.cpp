@@ -0,0 +1,56 @@
+//
+//  ofxBezierMeshSettings.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierMeshSettings.h"
+
+void ofxBezierMeshSettings::loadMeshSettingsJson(const ofJson & bezierJson){
+	bUseRibbonMesh = bezierJson["useRibbonMesh"].get <bool>();
+	ofLogVerbose("ofxBezierEditor") << "bUseRibbonMesh: " << bUseRibbonMesh;
+	ribbonWidth = bezierJson["ribbonWidth"].get <float>();
+	ofLogVerbose("ofxBezierEditor") << "ribbonWidth: " << ribbonWidth;
+	meshLengthPrecisionMultiplier = bezierJson["meshLengthPrecision"].get <int>();
+	ofLogVerbose("ofxBezierEditor") << "meshLengthPrecisionMultiplier: " << meshLengthPrecisionMultiplier;
+
+	bUseTubeMesh = bezierJson["useTubeMesh"].get <bool>();
+	ofLogVerbose("ofxBezierEditor") << "bUseTubeMesh: " << bUseTubeMesh;
+	tubeRadius = bezierJson["tubeRadius"].get <float>();
+	ofLogVerbose("ofxBezierEditor") << "tubeRadius: " << tubeRadius;
+	tubeResolution = bezierJson["tubeResolution"].get <int>();
+	ofLogVerbose("ofxBezierEditor") << "tubeResolution: " << tubeResolution;
+
+	bIsClosed = bezierJson["closed"].get <bool>();
+	ofLogVerbose("ofxBezierEditor") << "bIsClosed: " << bIsClosed;
+
+	// older files have no simplification settings
+	simplifyTolerance = bezierJson.value("simplifyTolerance", 0.0f);
+	simplifyMaxAngle = bezierJson.value("simplifyMaxAngle", 30.0f);
+	bArcLengthSampling = bezierJson.value("arcLengthSampling", false);
+	sampleSpacing = bezierJson.value("sampleSpacing", 4.0f);
+	curvatureWeight = bezierJson.value("curvatureWeight", 0.0f);
+	bMeshNormals = bezierJson.value("meshNormals", true);
+	bMeshTexCoords = bezierJson.value("meshTexCoords", true);
+}
+
+void ofxBezierMeshSettings::saveMeshSettingsJson(ofJson & bezierJson) const {
+	bezierJson["closed"] = bIsClosed;
+
+	bezierJson["useRibbonMesh"] = bUseRibbonMesh;
+	bezierJson["meshLengthPrecision"] = meshLengthPrecisionMultiplier;
+	bezierJson["ribbonWidth"] = ribbonWidth;
+
+	bezierJson["useTubeMesh"] = bUseTubeMesh;
+	bezierJson["tubeRadius"] = tubeRadius;
+	bezierJson["tubeResolution"] = tubeResolution;
+
+	bezierJson["simplifyTolerance"] = simplifyTolerance;
+	bezierJson["simplifyMaxAngle"] = simplifyMaxAngle;
+
+	bezierJson["arcLengthSampling"] = bArcLengthSampling;
+	bezierJson["sampleSpacing"] = sampleSpacing;
+	bezierJson["curvatureWeight"] = curvatureWeight;
+
+	bezierJson["meshNormals"] = bMeshNormals;
+	bezierJson["meshTexCoords"] = bMeshTexCoords;
+}
@@ -0,0 +1,147 @@
+//
+//  ofxBezierMeshSettings.h
+//  ofxBezierEditor
+//
+
+#pragma once
+#include "ofMain.h"
+
+// A read-only view of a run of points, what the static mesh builders take so any container
+// (a vector, a polyline, a stroke buffer) can be meshed without copying it into a polyline first.
+// The points are not owned and have to outlive the call.
+struct ofxBezierPointSpan {
+	const glm::vec3 * data = nullptr;
+	size_t size = 0;
+
+	ofxBezierPointSpan(){
+	}
+	ofxBezierPointSpan(const glm::vec3 * data, size_t size) : data(data), size(size){
+	}
+	ofxBezierPointSpan(const std::vector <glm::vec3> & points) : data(points.data()), size(points.size()){
+	}
+	ofxBezierPointSpan(const ofPolyline & line) : data(line.getVertices().data()), size(line.size()){
+	}
+};
+
+// The part of the settings that shapes the geometry and the meshes.
+// The mesh builders only need this, so a render-only curve can carry it without the
+// colours, JSON document and UI state of ofxBezierEditorSettings.
+class ofxBezierMeshSettings {
+	public:
+		bool getUseRibbonMesh(){
+			return bUseRibbonMesh;
+		}
+		void setUseRibbonMesh(bool b){
+			bUseRibbonMesh = b;
+		}
+		bool getUseTubeMesh(){
+			return bUseTubeMesh;
+		}
+		void setUseTubeMesh(bool b){
+			bUseTubeMesh = b;
+		}
+		void setMeshLengthPrecisionMultiplier(int m){
+			meshLengthPrecisionMultiplier = m;
+		}
+		int getMeshLengthPrecisionMultiplier(){
+			return meshLengthPrecisionMultiplier;
+		}
+		float getRibbonWidth(){
+			return ribbonWidth;
+		}
+		void setRibbonWidth(float w){
+			ribbonWidth = w;
+		}
+
+		void setTubeResolution(int r){
+			tubeResolution = r;
+		}
+		int getTubeResolution(){
+			return tubeResolution;
+		}
+		void setTubeRadius(float r){
+			tubeRadius = r;
+		}
+		float getTubeRadius(){
+			return tubeRadius;
+		}
+
+		bool getHasRoundCaps(){
+			return roundCap;
+		}
+		void setHasRoundCaps(bool b){
+			roundCap = b;
+		}
+
+		// Polylines are simplified within this distance before meshing, 0 turns it off
+		void setSimplifyTolerance(float t){
+			simplifyTolerance = t;
+		}
+		float getSimplifyTolerance(){
+			return simplifyTolerance;
+		}
+		void setSimplifyMaxAngle(float a){
+			simplifyMaxAngle = a;
+		}
+		float getSimplifyMaxAngle(){
+			return simplifyMaxAngle;
+		}
+
+		// Space the mesh samples by length along the curve instead of by polyline index. spacing is the
+		// distance between rings in curve units, curvatureWeight adds that many rings per radian of turning.
+		// The precision multiplier does not apply while this is on.
+		void setArcLengthSampling(bool b, float spacing = 4, float weight = 0){
+			bArcLengthSampling = b;
+			sampleSpacing = spacing;
+			curvatureWeight = weight;
+		}
+		bool getArcLengthSampling(){
+			return bArcLengthSampling;
+		}
+		float getSampleSpacing(){
+			return sampleSpacing;
+		}
+		float getCurvatureWeight(){
+			return curvatureWeight;
+		}
+
+		// Which attributes the meshes get besides positions. Drawing flat colour or with a shader that
+		// works out its own normals doesn't need them, leaving them out saves memory and upload time.
+		void setMeshAttributes(bool normals, bool texCoords){
+			bMeshNormals = normals;
+			bMeshTexCoords = texCoords;
+		}
+		bool getMeshNormals(){
+			return bMeshNormals;
+		}
+		bool getMeshTexCoords(){
+			return bMeshTexCoords;
+		}
+
+		void setClosed(bool b){
+			bIsClosed = b;
+		}
+		bool getClosed(){
+			return bIsClosed;
+		}
+
+		// Read and write the mesh fields of a "bezier" JSON object
+		void loadMeshSettingsJson(const ofJson & bezierJson);
+		void saveMeshSettingsJson(ofJson & bezierJson) const;
+
+		bool bIsClosed = false;
+		bool bUseRibbonMesh = false;
+		bool bUseTubeMesh = false;
+		int meshLengthPrecisionMultiplier = 1;
+		float ribbonWidth = 10.0;
+		int tubeResolution = 10;
+		float tubeRadius = 10.0;
+		bool roundCap = true;
+		float simplifyTolerance = 0;
+		float simplifyMaxAngle = 30;
+		bool bArcLengthSampling = false;
+		float sampleSpacing = 4.0;
+		float curvatureWeight = 0;
+		bool bMeshNormals = true;
+		bool bMeshTexCoords = true;
+};
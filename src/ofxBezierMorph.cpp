@@ -0,0 +1,198 @@
+//
+//  ofxBezierMorph.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierMorph.h"
+
+namespace {
+	// the components of glm vectors laid out one after the other, null for empty arrays
+	template <typename T>
+	const float * getFloats(const std::vector <T> & values){
+		return values.empty() ? nullptr : &values[0].x;
+	}
+
+	template <typename T>
+	float * getFloats(std::vector <T> & values){
+		return values.empty() ? nullptr : &values[0].x;
+	}
+}
+
+ofxBezierMorph::ofxBezierMorph(){
+}
+
+void ofxBezierMorph::Attribute::setup(const float * fromValues, const float * toValues, size_t count){
+	from.assign(fromValues, fromValues + count);
+	delta.resize(count);
+	for(size_t i = 0; i < count; i++){
+		delta[i] = toValues[i] - fromValues[i];
+	}
+}
+
+void ofxBezierMorph::Attribute::blend(float amount, float * values) const {
+	// plain arrays of floats so the compiler can vectorize the loop
+	const float * start = from.data();
+	const float * change = delta.data();
+	size_t count = from.size();
+	for(size_t i = 0; i < count; i++){
+		values[i] = start[i] + change[i] * amount;
+	}
+}
+
+bool ofxBezierMorph::isSameTopology(const ofMesh & from, const ofMesh & to){
+	return from.getMode() == to.getMode() && from.getNumVertices() == to.getNumVertices() &&
+		   from.getNormals().size() == to.getNormals().size() && from.getTexCoords().size() == to.getTexCoords().size() &&
+		   from.getIndices() == to.getIndices();
+}
+
+void ofxBezierMorph::getLengths(const ofPolyline & polyline, std::vector <float> & lengths){
+	const auto & points = polyline.getVertices();
+	lengths.resize(points.size());
+	float length = 0;
+	for(size_t i = 0; i < points.size(); i++){
+		if(i > 0){
+			length += glm::distance(points[i - 1], points[i]);
+		}
+		lengths[i] = length;
+	}
+}
+
+bool ofxBezierMorph::setup(ofxBezierCurve & from, ofxBezierCurve & to){
+	ofxBezierCurve * ends[2] = { &from, &to };
+	for(int i = 0; i < 2; i++){
+		vertices[i] = ends[i]->getVertices();
+		controlPoint1[i] = ends[i]->getControlPoints1();
+		controlPoint2[i] = ends[i]->getControlPoints2();
+		settings[i] = static_cast <const ofxBezierCurve &>(*ends[i]).getSettings();
+	}
+	strokeFrom = from.getColorStroke();
+	strokeTo = to.getColorStroke();
+
+	// the same number of segments and mesh settings give the same number of vertices, anything that
+	// samples by length or curvature gives different counts and is caught here too
+	const ofPolyline & polylineFrom = from.getPolyline();
+	const ofPolyline & polylineTo = to.getPolyline();
+	bBlending = polylineFrom.size() == polylineTo.size() && polylineFrom.isClosed() == polylineTo.isClosed() &&
+				isSameTopology(from.getRibbonMesh(), to.getRibbonMesh()) && isSameTopology(from.getTubeMesh(), to.getTubeMesh());
+	if(!bBlending){
+		if(vertices[0].size() != vertices[1].size()){
+			ofLogWarning("ofxBezierMorph") << "setup(): the curves have " << vertices[0].size() << " and " << vertices[1].size() << " vertices, the morph switches between them halfway";
+		}
+		polyline.clear();
+		lengths.clear();
+		ribbonMesh.clear();
+		tubeMesh.clear();
+		update(amount);
+		return false;
+	}
+
+	polyline = polylineFrom;
+	polylineBlend.setup(getFloats(polylineFrom.getVertices()), getFloats(polylineTo.getVertices()), polylineFrom.size() * 3);
+	std::vector <float> lengthsTo;
+	getLengths(polylineFrom, lengths);
+	getLengths(polylineTo, lengthsTo);
+	lengthBlend.setup(lengths.data(), lengthsTo.data(), lengths.size());
+	setupMesh(from.getRibbonMesh(), to.getRibbonMesh(), ribbonBlend, ribbonMesh);
+	setupMesh(from.getTubeMesh(), to.getTubeMesh(), tubeBlend, tubeMesh);
+	update(amount);
+	return true;
+}
+
+void ofxBezierMorph::setupMesh(const ofMesh & from, const ofMesh & to, MeshBlend & blend, ofVboMesh & mesh){
+	size_t count = from.getNumVertices();
+	blend.bNormals = count > 0 && from.getNormals().size() == count;
+	blend.bTexCoords = count > 0 && from.getTexCoords().size() == count;
+	blend.positions.setup(getFloats(from.getVertices()), getFloats(to.getVertices()), count * 3);
+	blend.normals.setup(getFloats(from.getNormals()), getFloats(to.getNormals()), blend.bNormals ? count * 3 : 0);
+	blend.texCoords.setup(getFloats(from.getTexCoords()), getFloats(to.getTexCoords()), blend.bTexCoords ? count * 2 : 0);
+
+	// the strip layout and indices are shared, only the values change from here on
+	mesh.clear();
+	mesh.setMode(from.getMode());
+	mesh.getVertices() = from.getVertices();
+	mesh.getNormals() = from.getNormals();
+	mesh.getTexCoords() = from.getTexCoords();
+	mesh.getIndices() = from.getIndices();
+}
+
+void ofxBezierMorph::update(float value){
+	amount = value;
+	if(bBlending){
+		polylineBlend.blend(amount, getFloats(polyline.getVertices()));
+		lengthBlend.blend(amount, lengths.data());
+		blendMesh(ribbonBlend, ribbonMesh);
+		blendMesh(tubeBlend, tubeMesh);
+		return;
+	}
+
+	// the shape settings of the nearest end, widths in between
+	int nearest = amount < 0.5 ? 0 : 1;
+	ofxBezierMeshSettings & curveSettings = curve.getSettings();
+	curveSettings = settings[nearest];
+	curveSettings.ribbonWidth = ofLerp(settings[0].ribbonWidth, settings[1].ribbonWidth, amount);
+	curveSettings.tubeRadius = ofLerp(settings[0].tubeRadius, settings[1].tubeRadius, amount);
+	if(vertices[0].size() != vertices[1].size()){
+		curve.setPoints(vertices[nearest], controlPoint1[nearest], controlPoint2[nearest]);
+		return;
+	}
+	std::vector <glm::vec2> points[3];
+	for(size_t i = 0; i < vertices[0].size(); i++){
+		points[0].push_back(glm::mix(vertices[0][i], vertices[1][i], amount));
+		points[1].push_back(glm::mix(controlPoint1[0][i], controlPoint1[1][i], amount));
+		points[2].push_back(glm::mix(controlPoint2[0][i], controlPoint2[1][i], amount));
+	}
+	curve.setPoints(points[0], points[1], points[2]);
+}
+
+void ofxBezierMorph::blendMesh(const MeshBlend & blend, ofVboMesh & mesh){
+	if(mesh.getNumVertices() == 0){
+		return;
+	}
+	blend.positions.blend(amount, getFloats(mesh.getVertices()));
+	if(blend.bTexCoords){
+		blend.texCoords.blend(amount, getFloats(mesh.getTexCoords()));
+	}
+	if(blend.bNormals){
+		auto & normals = mesh.getNormals();
+		blend.normals.blend(amount, getFloats(normals));
+		for(size_t i = 0; i < normals.size(); i++){
+			float length2 = glm::length2(normals[i]);
+			if(length2 > 1e-12){
+				normals[i] /= std::sqrt(length2);
+			}else{
+				// the two ends point opposite ways here, take the nearest one
+				const float * start = &blend.normals.from[i * 3];
+				const float * change = &blend.normals.delta[i * 3];
+				float side = amount < 0.5 ? 0 : 1;
+				normals[i] = glm::vec3(start[0] + change[0] * side, start[1] + change[1] * side, start[2] + change[2] * side);
+			}
+		}
+	}
+}
+
+const ofPolyline & ofxBezierMorph::getPolyline(){
+	return bBlending ? polyline : curve.getPolyline();
+}
+
+const ofVboMesh & ofxBezierMorph::getRibbonMesh(){
+	return bBlending ? ribbonMesh : curve.getRibbonMesh();
+}
+
+const ofVboMesh & ofxBezierMorph::getTubeMesh(){
+	return bBlending ? tubeMesh : curve.getTubeMesh();
+}
+
+void ofxBezierMorph::draw(){
+	ofPushStyle();
+	ofSetColor(strokeFrom.getLerped(strokeTo, amount));
+	getPolyline().draw();
+	ofPopStyle();
+}
+
+void ofxBezierMorph::drawRibbon(){
+	getRibbonMesh().draw();
+}
+
+void ofxBezierMorph::drawTube(){
+	getTubeMesh().draw();
+}
@@ -0,0 +1,89 @@
+//
+//  ofxBezierMorph.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxBezierCurve.h"
+
+// An in-between of two curves. When both ends have the same number of segments and the same mesh
+// settings their polylines, ribbons and tubes line up vertex for vertex, so the two ends are built
+// once and every update() is a single pass over the vertex data: positions, texture coordinates and
+// the length along the polyline are interpolated and normals interpolated and renormalized.
+// Ends that don't line up fall back to interpolating the points and rebuilding (or, if they don't
+// even have the same number of vertices, to switching from one to the other halfway).
+class ofxBezierMorph {
+	public:
+		ofxBezierMorph();
+
+		// Builds both ends, returns false if their meshes don't line up and updates will rebuild.
+		// Changes to the curves afterwards need another setup().
+		bool setup(ofxBezierCurve & from, ofxBezierCurve & to);
+		// 0 is the first curve, 1 the second
+		void update(float amount);
+		float getAmount() const {
+			return amount;
+		}
+		// whether update() blends meshes rather than rebuilding them
+		bool isBlending() const {
+			return bBlending;
+		}
+
+		const ofPolyline & getPolyline();
+		// length along the polyline up to each of its vertices
+		const std::vector <float> & getLengths() const {
+			return lengths;
+		}
+		const ofVboMesh & getRibbonMesh();
+		const ofVboMesh & getTubeMesh();
+
+		void draw();
+		void drawRibbon();
+		void drawTube();
+
+	private:
+		// an attribute of both ends as floats, the second end stored as the difference to the first
+		struct Attribute {
+			std::vector <float> from;
+			std::vector <float> delta;
+
+			void setup(const float * fromValues, const float * toValues, size_t count);
+			void blend(float amount, float * values) const;
+		};
+
+		struct MeshBlend {
+			Attribute positions;
+			Attribute normals;
+			Attribute texCoords;
+			bool bNormals = false;
+			bool bTexCoords = false;
+		};
+
+		static bool isSameTopology(const ofMesh & from, const ofMesh & to);
+		static void getLengths(const ofPolyline & polyline, std::vector <float> & lengths);
+		void setupMesh(const ofMesh & from, const ofMesh & to, MeshBlend & blend, ofVboMesh & mesh);
+		void blendMesh(const MeshBlend & blend, ofVboMesh & mesh);
+
+		bool bBlending = false;
+		float amount = 0;
+
+		ofPolyline polyline;
+		Attribute polylineBlend;
+		std::vector <float> lengths;
+		Attribute lengthBlend;
+		ofVboMesh ribbonMesh;
+		MeshBlend ribbonBlend;
+		ofVboMesh tubeMesh;
+		MeshBlend tubeBlend;
+		ofColor strokeFrom;
+		ofColor strokeTo;
+
+		// the points of both ends and the curve rebuilt from them when the meshes can't be blended
+		std::vector <glm::vec2> vertices[2];
+		std::vector <glm::vec2> controlPoint1[2];
+		std::vector <glm::vec2> controlPoint2[2];
+		ofxBezierMeshSettings settings[2];
+		ofxBezierCurve curve;
+};
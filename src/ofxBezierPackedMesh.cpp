@@ -0,0 +1,340 @@
+//
+//  ofxBezierPackedMesh.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierPackedMesh.h"
+#include <cstring>
+
+namespace {
+	uint16_t toHalf(float value){
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		uint16_t sign = (bits >> 16) & 0x8000;
+		int exponent = int((bits >> 23) & 0xff) - 127 + 15;
+		uint32_t mantissa = bits & 0x7fffff;
+		if(exponent <= 0){
+			// too small for a normal half, zero is close enough for unit vectors
+			return sign;
+		}
+		if(exponent >= 31){
+			return sign | 0x7c00;
+		}
+		// round to nearest, a carry into the exponent is still the right value
+		uint16_t half = sign | (exponent << 10) | (mantissa >> 13);
+		if(mantissa & 0x1000){
+			half++;
+		}
+		return half;
+	}
+
+	int16_t toSnorm16(float value){
+		return (int16_t)std::round(ofClamp(value, -1, 1) * 32767.0f);
+	}
+
+	uint16_t toUnorm16(float value){
+		return (uint16_t)std::round(ofClamp(value, 0, 1) * 65535.0f);
+	}
+
+	// x, y and z as signed 10 bit values from the lowest bits up, the 2 bit w is left at 0
+	uint32_t toPacked10(const glm::vec3 & value){
+		uint32_t packed = 0;
+		for(int axis = 0; axis < 3; axis++){
+			int32_t component = (int32_t)std::round(ofClamp(value[axis], -1, 1) * 511.0f);
+			packed |= ((uint32_t)component & 0x3ff) << (axis * 10);
+		}
+		return packed;
+	}
+
+	template <typename T>
+	void write(uint8_t * & cursor, const T & value){
+		std::memcpy(cursor, &value, sizeof(T));
+		cursor += sizeof(T);
+	}
+
+	const std::string vertexShader = R"(#version 150
+uniform mat4 modelViewProjectionMatrix;
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+in vec4 position;
+void main(){
+	gl_Position = modelViewProjectionMatrix * vec4(positionOffset + position.xyz * positionScale, 1.0);
+}
+)";
+
+	const std::string fragmentShader = R"(#version 150
+uniform vec4 globalColor;
+out vec4 outputColor;
+void main(){
+	outputColor = globalColor;
+}
+)";
+}
+
+ofxBezierPackedMesh::ofxBezierPackedMesh(){
+}
+
+ofxBezierPackedMesh::~ofxBezierPackedMesh(){
+	if(vao != 0){
+		glDeleteVertexArrays(1, &vao);
+	}
+}
+
+ofxBezierPackedMesh::ofxBezierPackedMesh(const ofxBezierPackedMesh & other){
+	*this = other;
+}
+
+ofxBezierPackedMesh & ofxBezierPackedMesh::operator=(const ofxBezierPackedMesh & other){
+	if(this == &other){
+		return *this;
+	}
+	format = other.format;
+	packedFormat = other.packedFormat;
+	mode = other.mode;
+	bytes = other.bytes;
+	vertexCount = other.vertexCount;
+	stride = other.stride;
+	normalByteOffset = other.normalByteOffset;
+	texCoordByteOffset = other.texCoordByteOffset;
+	positionOffset = other.positionOffset;
+	positionScale = other.positionScale;
+	texCoordOffset = other.texCoordOffset;
+	texCoordScale = other.texCoordScale;
+	// ofBufferObject copies share the GL buffer, we want our own
+	buffer = ofBufferObject();
+	bDataDirty = true;
+	bLayoutDirty = true;
+	return *this;
+}
+
+void ofxBezierPackedMesh::setFormat(const Format & value){
+	format = value;
+}
+
+void ofxBezierPackedMesh::clear(){
+	bytes.clear();
+	vertexCount = 0;
+	bDataDirty = true;
+}
+
+void ofxBezierPackedMesh::update(const ofMesh & mesh){
+	const auto & vertices = mesh.getVertices();
+	const auto & normals = mesh.getNormals();
+	const auto & texCoords = mesh.getTexCoords();
+	bool bNormals = !normals.empty() && normals.size() == vertices.size();
+	bool bTexCoords = !texCoords.empty() && texCoords.size() == vertices.size();
+
+	// the layout, every attribute starts on 4 bytes and 16 bit triples are padded to 4 values
+	size_t newStride = format.bQuantizePositions ? 4 * sizeof(uint16_t) : 3 * sizeof(float);
+	int newNormalOffset = -1;
+	if(bNormals){
+		newNormalOffset = newStride;
+		if(format.normals == NORMALS_FLOAT){
+			newStride += 3 * sizeof(float);
+		}else if(format.normals == NORMALS_PACKED){
+			newStride += sizeof(uint32_t);
+		}else{
+			newStride += 4 * sizeof(uint16_t);
+		}
+	}
+	int newTexCoordOffset = -1;
+	if(bTexCoords){
+		newTexCoordOffset = newStride;
+		newStride += format.bUnorm16TexCoords ? 2 * sizeof(uint16_t) : 2 * sizeof(float);
+	}
+	if(newStride != stride || newNormalOffset != normalByteOffset || newTexCoordOffset != texCoordByteOffset || mesh.getMode() != mode ||
+	   format.normals != packedFormat.normals || format.bUnorm16TexCoords != packedFormat.bUnorm16TexCoords || format.bQuantizePositions != packedFormat.bQuantizePositions){
+		bLayoutDirty = true;
+	}
+	packedFormat = format;
+	stride = newStride;
+	normalByteOffset = newNormalOffset;
+	texCoordByteOffset = newTexCoordOffset;
+	mode = mesh.getMode();
+	vertexCount = vertices.size();
+
+	// quantized values are relative to their bounds
+	positionOffset = glm::vec3(0, 0, 0);
+	positionScale = glm::vec3(1, 1, 1);
+	if(format.bQuantizePositions && vertexCount > 0){
+		glm::vec3 low = vertices[0];
+		glm::vec3 high = vertices[0];
+		for(const auto & vertex : vertices){
+			low = glm::min(low, vertex);
+			high = glm::max(high, vertex);
+		}
+		positionOffset = low;
+		positionScale = high - low;
+		for(int axis = 0; axis < 3; axis++){
+			if(positionScale[axis] <= 0){
+				positionScale[axis] = 1;
+			}
+		}
+	}
+	texCoordOffset = glm::vec2(0, 0);
+	texCoordScale = glm::vec2(1, 1);
+	if(bTexCoords && format.bUnorm16TexCoords){
+		glm::vec2 low = texCoords[0];
+		glm::vec2 high = texCoords[0];
+		for(const auto & texCoord : texCoords){
+			low = glm::min(low, texCoord);
+			high = glm::max(high, texCoord);
+		}
+		// 0-1 coordinates are stored as they are, longer ones (e.g. lengths along the curve) by their range
+		if(low.x < 0 || low.y < 0 || high.x > 1 || high.y > 1){
+			texCoordOffset = low;
+			texCoordScale = high - low;
+			for(int axis = 0; axis < 2; axis++){
+				if(texCoordScale[axis] <= 0){
+					texCoordScale[axis] = 1;
+				}
+			}
+		}
+	}
+
+	bytes.resize(vertexCount * stride);
+	uint8_t * cursor = bytes.data();
+	for(size_t i = 0; i < vertexCount; i++){
+		if(format.bQuantizePositions){
+			glm::vec3 position = (vertices[i] - positionOffset) / positionScale;
+			write(cursor, toUnorm16(position.x));
+			write(cursor, toUnorm16(position.y));
+			write(cursor, toUnorm16(position.z));
+			write(cursor, (uint16_t)0);
+		}else{
+			write(cursor, vertices[i]);
+		}
+		if(bNormals){
+			const glm::vec3 & normal = normals[i];
+			if(format.normals == NORMALS_FLOAT){
+				write(cursor, normal);
+			}else if(format.normals == NORMALS_PACKED){
+				write(cursor, toPacked10(normal));
+			}else if(format.normals == NORMALS_HALF){
+				write(cursor, toHalf(normal.x));
+				write(cursor, toHalf(normal.y));
+				write(cursor, toHalf(normal.z));
+				write(cursor, (uint16_t)0);
+			}else{
+				write(cursor, toSnorm16(normal.x));
+				write(cursor, toSnorm16(normal.y));
+				write(cursor, toSnorm16(normal.z));
+				write(cursor, (int16_t)0);
+			}
+		}
+		if(bTexCoords){
+			if(format.bUnorm16TexCoords){
+				glm::vec2 texCoord = (texCoords[i] - texCoordOffset) / texCoordScale;
+				write(cursor, toUnorm16(texCoord.x));
+				write(cursor, toUnorm16(texCoord.y));
+			}else{
+				write(cursor, texCoords[i]);
+			}
+		}
+	}
+	bDataDirty = true;
+}
+
+void ofxBezierPackedMesh::upload(){
+	if(!bDataDirty){
+		return;
+	}
+	if(!buffer.isAllocated() || buffer.size() < bytes.size()){
+		// the buffer is only ever grown, an edit that adds a few vertices shouldn't reallocate it
+		buffer.allocate(std::max(bytes.size(), buffer.size() * 2), GL_DYNAMIC_DRAW);
+		bLayoutDirty = true;
+	}
+	if(!bytes.empty()){
+		buffer.updateData(0, bytes.size(), bytes.data());
+	}
+	bDataDirty = false;
+}
+
+void ofxBezierPackedMesh::bind(){
+	upload();
+	if(vao == 0){
+		glGenVertexArrays(1, &vao);
+		bLayoutDirty = true;
+	}
+	glBindVertexArray(vao);
+	if(bLayoutDirty){
+		buffer.bind(GL_ARRAY_BUFFER);
+		if(packedFormat.bQuantizePositions){
+			glVertexAttribPointer(ofShader::POSITION_ATTRIBUTE, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void *)0);
+		}else{
+			glVertexAttribPointer(ofShader::POSITION_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+		}
+		glEnableVertexAttribArray(ofShader::POSITION_ATTRIBUTE);
+
+		if(normalByteOffset >= 0){
+			void * offset = (void *)(uintptr_t)normalByteOffset;
+			if(packedFormat.normals == NORMALS_FLOAT){
+				glVertexAttribPointer(ofShader::NORMAL_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, stride, offset);
+			}else if(packedFormat.normals == NORMALS_PACKED){
+				// packed formats always come as 4 components, the shader only reads xyz
+				glVertexAttribPointer(ofShader::NORMAL_ATTRIBUTE, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset);
+			}else if(packedFormat.normals == NORMALS_HALF){
+				glVertexAttribPointer(ofShader::NORMAL_ATTRIBUTE, 3, GL_HALF_FLOAT, GL_FALSE, stride, offset);
+			}else{
+				glVertexAttribPointer(ofShader::NORMAL_ATTRIBUTE, 3, GL_SHORT, GL_TRUE, stride, offset);
+			}
+			glEnableVertexAttribArray(ofShader::NORMAL_ATTRIBUTE);
+		}else{
+			glDisableVertexAttribArray(ofShader::NORMAL_ATTRIBUTE);
+		}
+
+		if(texCoordByteOffset >= 0){
+			void * offset = (void *)(uintptr_t)texCoordByteOffset;
+			if(packedFormat.bUnorm16TexCoords){
+				glVertexAttribPointer(ofShader::TEXCOORD_ATTRIBUTE, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, offset);
+			}else{
+				glVertexAttribPointer(ofShader::TEXCOORD_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, stride, offset);
+			}
+			glEnableVertexAttribArray(ofShader::TEXCOORD_ATTRIBUTE);
+		}else{
+			glDisableVertexAttribArray(ofShader::TEXCOORD_ATTRIBUTE);
+		}
+		buffer.unbind(GL_ARRAY_BUFFER);
+		bLayoutDirty = false;
+	}
+}
+
+void ofxBezierPackedMesh::unbind(){
+	glBindVertexArray(0);
+}
+
+void ofxBezierPackedMesh::draw(){
+	if(vertexCount == 0){
+		return;
+	}
+	if(!ofIsGLProgrammableRenderer()){
+		static bool bWarned = false;
+		if(!bWarned){
+			ofLogWarning("ofxBezierPackedMesh") << "draw(): packed meshes need the programmable renderer";
+			bWarned = true;
+		}
+		return;
+	}
+	ofShader & shader = getShader();
+	shader.begin();
+	shader.setUniform3f("positionOffset", positionOffset);
+	shader.setUniform3f("positionScale", positionScale);
+	bind();
+	glDrawArrays(ofGetGLPrimitiveMode(mode), 0, vertexCount);
+	unbind();
+	shader.end();
+}
+
+ofShader & ofxBezierPackedMesh::getShader(){
+	// one for all packed meshes, made on the first draw when there is a GL context
+	static ofShader shader;
+	static bool bSetUp = false;
+	if(!bSetUp){
+		bSetUp = true;
+		shader.setupShaderFromSource(GL_VERTEX_SHADER, vertexShader);
+		shader.setupShaderFromSource(GL_FRAGMENT_SHADER, fragmentShader);
+		shader.bindDefaults();
+		shader.linkProgram();
+	}
+	return shader;
+}
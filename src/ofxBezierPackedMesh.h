@@ -0,0 +1,110 @@
+//
+//  ofxBezierPackedMesh.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+// A ribbon or tube mesh packed into one interleaved vertex buffer with compact attribute formats:
+// normals as 10 bit snorm (GL_INT_2_10_10_10_REV), half floats or snorm16, texture coordinates as
+// unorm16 and, optionally, positions as unorm16 relative to the mesh's bounding box. A tube vertex
+// goes from 32 bytes (float position, normal and texture coordinate) to 20: 12 for the position,
+// 4 for the normal and 4 for the texture coordinate. Half float and snorm16 normals are padded to
+// four values, 8 bytes, so those layouts take 24. Quantized positions take 8 bytes instead of 12.
+// The attributes are at ofShader's default locations. Quantized positions (and texture coordinates
+// outside 0-1) are stored relative to their bounds: in the shader they are offset + value * scale.
+// Needs the programmable renderer.
+class ofxBezierPackedMesh {
+	public:
+		enum NormalFormat {
+			NORMALS_FLOAT,
+			NORMALS_HALF,
+			NORMALS_SNORM16,
+			// three 10 bit components in 4 bytes, about 0.002 of precision which is plenty for lighting
+			NORMALS_PACKED
+		};
+
+		struct Format {
+			NormalFormat normals = NORMALS_PACKED;
+			bool bUnorm16TexCoords = true;
+			bool bQuantizePositions = false;
+		};
+
+		ofxBezierPackedMesh();
+		~ofxBezierPackedMesh();
+		// copies get their own buffer, uploaded on their first draw
+		ofxBezierPackedMesh(const ofxBezierPackedMesh & other);
+		ofxBezierPackedMesh & operator=(const ofxBezierPackedMesh & other);
+
+		// takes effect at the next update()
+		void setFormat(const Format & value);
+		const Format & getFormat() const {
+			return format;
+		}
+
+		// Packs the positions, normals and texture coordinates of mesh (the ones it has) in the current format
+		void update(const ofMesh & mesh);
+		void clear();
+
+		// Draws in the current colour with a built-in shader that decodes the positions
+		void draw();
+		// Binds the vertex array for drawing with your own shader, see getPositionOffset()
+		void bind();
+		void unbind();
+
+		size_t getVertexCount() const {
+			return vertexCount;
+		}
+		size_t getStride() const {
+			return stride;
+		}
+		size_t getByteSize() const {
+			return bytes.size();
+		}
+		bool hasNormals() const {
+			return normalByteOffset >= 0;
+		}
+		bool hasTexCoords() const {
+			return texCoordByteOffset >= 0;
+		}
+		// how positions and texture coordinates are decoded, 0 and 1 unless they are quantized
+		const glm::vec3 & getPositionOffset() const {
+			return positionOffset;
+		}
+		const glm::vec3 & getPositionScale() const {
+			return positionScale;
+		}
+		const glm::vec2 & getTexCoordOffset() const {
+			return texCoordOffset;
+		}
+		const glm::vec2 & getTexCoordScale() const {
+			return texCoordScale;
+		}
+
+	private:
+		void upload();
+		static ofShader & getShader();
+
+		Format format;
+		// the format the bytes are in, format only applies from the next update()
+		Format packedFormat;
+		ofPrimitiveMode mode = OF_PRIMITIVE_TRIANGLE_STRIP;
+		std::vector <uint8_t> bytes;
+		size_t vertexCount = 0;
+		size_t stride = 0;
+		// byte offsets inside a vertex, -1 if the mesh has no such attribute
+		int normalByteOffset = -1;
+		int texCoordByteOffset = -1;
+
+		glm::vec3 positionOffset;
+		glm::vec3 positionScale = glm::vec3(1, 1, 1);
+		glm::vec2 texCoordOffset;
+		glm::vec2 texCoordScale = glm::vec2(1, 1);
+
+		ofBufferObject buffer;
+		GLuint vao = 0;
+		bool bDataDirty = false;
+		bool bLayoutDirty = true;
+};
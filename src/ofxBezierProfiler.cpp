@@ -0,0 +1,152 @@
+//
+//  ofxBezierProfiler.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierProfiler.h"
+
+ofxBezierProfiler::ofxBezierProfiler(){
+}
+
+void ofxBezierProfiler::setHistorySize(size_t size){
+	historySize = size;
+	while(history.size() > historySize){
+		history.pop_front();
+	}
+}
+
+void ofxBezierProfiler::beginRebuild(const std::string & trigger){
+	if(!bEnabled || bInRebuild){
+		return;
+	}
+	bInRebuild = true;
+	current = Rebuild();
+	current.trigger = trigger;
+	current.frame = ofGetFrameNum();
+	current.startMicros = ofGetElapsedTimeMicros();
+}
+
+void ofxBezierProfiler::beginStage(Stage stage){
+	if(!bInRebuild){
+		return;
+	}
+	current.stageStartMicros[stage] = ofGetElapsedTimeMicros();
+}
+
+void ofxBezierProfiler::endStage(Stage stage){
+	if(!bInRebuild){
+		return;
+	}
+	// a stage can run more than once per rebuild, so we accumulate
+	current.stageMicros[stage] += ofGetElapsedTimeMicros() - current.stageStartMicros[stage];
+	current.stageRan[stage] = true;
+}
+
+void ofxBezierProfiler::endRebuild(){
+	if(!bInRebuild){
+		return;
+	}
+	bInRebuild = false;
+	current.totalMicros = ofGetElapsedTimeMicros() - current.startMicros;
+
+	last = current;
+	rebuildCount++;
+	triggerCounts[current.trigger]++;
+
+	if(historySize > 0){
+		history.push_back(current);
+		while(history.size() > historySize){
+			history.pop_front();
+		}
+	}
+}
+
+void ofxBezierProfiler::clear(){
+	history.clear();
+	triggerCounts.clear();
+	rebuildCount = 0;
+	last = Rebuild();
+}
+
+ofJson ofxBezierProfiler::getChromeTrace(const std::string & processName) const {
+	ofJson trace;
+	trace["displayTimeUnit"] = "ms";
+	trace["traceEvents"] = ofJson::array();
+
+	ofJson processMeta;
+	processMeta["name"] = "process_name";
+	processMeta["ph"] = "M";
+	processMeta["pid"] = 1;
+	processMeta["tid"] = 1;
+	processMeta["args"]["name"] = processName;
+	trace["traceEvents"].push_back(processMeta);
+
+	for(const auto & rebuild : history){
+		// one complete event for the whole rebuild...
+		ofJson event;
+		event["name"] = "updateAllFromVertices";
+		event["cat"] = "ofxBezierEditor";
+		event["ph"] = "X";
+		event["pid"] = 1;
+		event["tid"] = 1;
+		event["ts"] = rebuild.startMicros;
+		event["dur"] = rebuild.totalMicros;
+		event["args"]["trigger"] = rebuild.trigger;
+		event["args"]["frame"] = rebuild.frame;
+		event["args"]["curveVertices"] = rebuild.curveVertices;
+		event["args"]["polylineVertices"] = rebuild.polylineVertices;
+		event["args"]["ribbonVertices"] = rebuild.ribbonVertices;
+		event["args"]["tubeVertices"] = rebuild.tubeVertices;
+		event["args"]["tubeRings"] = rebuild.tubeRings;
+		event["args"]["changedSegments"] = rebuild.changedSegments;
+		event["args"]["rebuiltChunks"] = rebuild.rebuiltChunks;
+		event["args"]["mergedInputEvents"] = rebuild.mergedInputEvents;
+		event["args"]["bufferGrowths"] = rebuild.bufferGrowths;
+		event["args"]["simplifyReductionRatio"] = rebuild.simplifyReductionRatio;
+		trace["traceEvents"].push_back(event);
+
+		// ...and one nested event per stage that ran
+		for(int i = 0; i < STAGE_COUNT; i++){
+			if(!rebuild.stageRan[i]){
+				continue;
+			}
+			ofJson stageEvent;
+			stageEvent["name"] = getStageName((Stage)i);
+			stageEvent["cat"] = "ofxBezierEditor";
+			stageEvent["ph"] = "X";
+			stageEvent["pid"] = 1;
+			stageEvent["tid"] = 1;
+			stageEvent["ts"] = rebuild.stageStartMicros[i];
+			stageEvent["dur"] = rebuild.stageMicros[i];
+			trace["traceEvents"].push_back(stageEvent);
+		}
+	}
+	return trace;
+}
+
+bool ofxBezierProfiler::saveChromeTrace(const std::string & filename, const std::string & processName) const {
+	return ofSaveJson(filename, getChromeTrace(processName));
+}
+
+std::string ofxBezierProfiler::getStageName(Stage stage){
+	switch(stage){
+		case STAGE_POLYLINE:
+			return "updatePolyline";
+		case STAGE_BOUNDING_BOX:
+			return "updateBoundingBox";
+		case STAGE_CENTER:
+			return "calculateCenter";
+		case STAGE_RIBBON_MESH:
+			return "ribbonMesh";
+		case STAGE_TUBE_MESH:
+			return "tubeMesh";
+		case STAGE_MESH_LOD:
+			return "meshLod";
+		case STAGE_SEGMENT_TREE:
+			return "segmentTree";
+		case STAGE_FILL:
+			return "fillMesh";
+		default:
+			return "unknown";
+	}
+}
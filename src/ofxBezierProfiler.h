@@ -0,0 +1,140 @@
+//
+//  ofxBezierProfiler.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+// Define OFX_BEZIER_PROFILING to 0 before including the addon (or in the project
+// defines) to compile all instrumentation in updateAllFromVertices away.
+#ifndef OFX_BEZIER_PROFILING
+#define OFX_BEZIER_PROFILING 1
+#endif
+
+class ofxBezierProfiler {
+	public:
+		enum Stage {
+			STAGE_POLYLINE = 0,
+			STAGE_BOUNDING_BOX,
+			STAGE_CENTER,
+			STAGE_RIBBON_MESH,
+			STAGE_TUBE_MESH,
+			STAGE_MESH_LOD,
+			STAGE_SEGMENT_TREE,
+			STAGE_FILL,
+			STAGE_COUNT
+		};
+
+		// Everything we know about a single call to updateAllFromVertices
+		struct Rebuild {
+			std::string trigger;
+			uint64_t frame = 0;
+			uint64_t startMicros = 0;
+			uint64_t totalMicros = 0;
+			uint64_t stageStartMicros[STAGE_COUNT] = {};
+			uint64_t stageMicros[STAGE_COUNT] = {};
+			bool stageRan[STAGE_COUNT] = {};
+
+			size_t curveVertices = 0;
+			size_t polylineVertices = 0;
+			size_t ribbonVertices = 0;
+			size_t tubeVertices = 0;
+			size_t tubeRings = 0;
+			// segments whose bounds had to be recomputed
+			size_t changedSegments = 0;
+			// ribbon and tube chunks rebuilt, when chunked meshes are on
+			size_t rebuiltChunks = 0;
+			// input events coalesced into this rebuild besides the one that triggered it
+			size_t mergedInputEvents = 0;
+			// reused buffers of the mesh builders whose capacity grew, 0 once they fit the curve.
+			// A sign of allocation, not a count: see ofxBezierTubeMeshBuilder::getBufferGrowths()
+			size_t bufferGrowths = 0;
+			// polyline vertices over meshed vertices, 1 when simplification is off
+			float simplifyReductionRatio = 1.0;
+		};
+
+		// Times the enclosing scope as one stage of the current rebuild
+		class ScopedStage {
+			public:
+				ScopedStage(ofxBezierProfiler & profiler, Stage stage) : profiler(profiler), stage(stage){
+					profiler.beginStage(stage);
+				}
+				~ScopedStage(){
+					profiler.endStage(stage);
+				}
+			private:
+				ofxBezierProfiler & profiler;
+				Stage stage;
+		};
+
+		ofxBezierProfiler();
+
+		void setEnabled(bool value){
+			bEnabled = value;
+		}
+		bool isEnabled() const {
+			return bEnabled;
+		}
+
+		void setHistorySize(size_t size);
+		size_t getHistorySize() const {
+			return historySize;
+		}
+
+		void beginRebuild(const std::string & trigger);
+		void beginStage(Stage stage);
+		void endStage(Stage stage);
+		void endRebuild();
+
+		// counters of the rebuild in progress, filled in by the editor
+		Rebuild & getCurrentRebuild(){
+			return current;
+		}
+
+		const Rebuild & getLastRebuild() const {
+			return last;
+		}
+		const std::deque <Rebuild> & getHistory() const {
+			return history;
+		}
+		uint64_t getRebuildCount() const {
+			return rebuildCount;
+		}
+		const std::map <std::string, uint64_t> & getTriggerCounts() const {
+			return triggerCounts;
+		}
+		void clear();
+
+		// Chrome trace-event format, open with chrome://tracing or ui.perfetto.dev
+		ofJson getChromeTrace(const std::string & processName = "ofxBezierEditor") const;
+		bool saveChromeTrace(const std::string & filename, const std::string & processName = "ofxBezierEditor") const;
+
+		static std::string getStageName(Stage stage);
+
+	private:
+		bool bEnabled = true;
+		bool bInRebuild = false;
+		size_t historySize = 120;
+		uint64_t rebuildCount = 0;
+
+		Rebuild current;
+		Rebuild last;
+		std::deque <Rebuild> history;
+		std::map <std::string, uint64_t> triggerCounts;
+};
+
+#if OFX_BEZIER_PROFILING
+#define OFX_BEZIER_PROFILE_BEGIN(profiler, trigger) (profiler).beginRebuild(trigger)
+#define OFX_BEZIER_PROFILE_STAGE(profiler, stage) ofxBezierProfiler::ScopedStage ofxBezierProfileScope_ ## stage((profiler), ofxBezierProfiler::stage)
+#define OFX_BEZIER_PROFILE_COUNT(profiler, counter, value) (profiler).getCurrentRebuild().counter = (value)
+#define OFX_BEZIER_PROFILE_ADD(profiler, counter, value) (profiler).getCurrentRebuild().counter += (value)
+#define OFX_BEZIER_PROFILE_END(profiler) (profiler).endRebuild()
+#else
+#define OFX_BEZIER_PROFILE_BEGIN(profiler, trigger)
+#define OFX_BEZIER_PROFILE_STAGE(profiler, stage)
+#define OFX_BEZIER_PROFILE_COUNT(profiler, counter, value)
+#define OFX_BEZIER_PROFILE_ADD(profiler, counter, value)
+#define OFX_BEZIER_PROFILE_END(profiler)
+#endif
@@ -7,8 +7,9 @@
 
 #include "ofxBezierRibbonMeshBuilder.h"
 #include "ofxBezierUtility.h"
+#include "ofxBezierCapTemplates.h"
 
-ofxBezierRibbonMeshBuilder::ofxBezierRibbonMeshBuilder(ofxBezierEditorSettings & settings) : settings(settings){
+ofxBezierRibbonMeshBuilder::ofxBezierRibbonMeshBuilder(ofxBezierMeshSettings & settings) : settings(settings){
 
 }
 
@@ -16,83 +17,146 @@ ofxBezierRibbonMeshBuilder::~ofxBezierRibbonMeshBuilder(){
 	// Cleanup
 }
 
-ofVboMesh ofxBezierRibbonMeshBuilder::getRibbonMeshFromPolyline(ofPolyline inPoly){
+ofVboMesh ofxBezierRibbonMeshBuilder::getRibbonMeshFromPolyline(const ofPolyline & inPoly){
 	generateRibbonMeshFromPolyline(inPoly);
 	return ribbonMesh;
 }
 
-void ofxBezierRibbonMeshBuilder::generateRibbonMeshFromPolyline(ofPolyline inPoly){
-	if(inPoly.getVertices().size() > 2){
-		// Clear mesh (triangle strip)
-		ribbonMesh.clear();
-		ribbonMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
-		ofPolyline workerLine;
-
-		vector <ofVec3f> points;
-		vector <ofVec3f> tangents;
-		segmentDistances.clear();
-		totalLineLength = 0;
-
-		ofxBezierUtility::ReflectEndPoints(inPoly, workerLine);
-		ofxBezierUtility::CalculateInterpolatedTangentsAndPoints(workerLine, points, tangents, settings.meshLengthPrecisionMultiplier);
-		ofxBezierUtility::CalculateLineLengths(points, segmentDistances, totalLineLength, settings.roundCap, settings.ribbonWidth);
-
-        if(settings.roundCap && !settings.bIsClosed){
-			//get the poiunts on a hald circle for the cap, the circle centre is the first point and the direction is the tangent. There should be 20 pounts on the half circle.
-			generateCurvedRibbonCap(points[0], tangents[0], true, totalLineLength);
+void ofxBezierRibbonMeshBuilder::moveRibbonMeshInto(ofMesh & target){
+	target.clear();
+	target.setMode(ribbonMesh.getMode());
+	std::swap(target.getVertices(), ribbonMesh.getVertices());
+	std::swap(target.getTexCoords(), ribbonMesh.getTexCoords());
+}
+
+void ofxBezierRibbonMeshBuilder::BuildRibbonMesh(const ofxBezierPointSpan & points, const ofxBezierMeshSettings & settings, ofMesh & output){
+	ofxBezierMeshSettings buildSettings = settings;
+	ofxBezierRibbonMeshBuilder builder(buildSettings);
+	ofPolyline line;
+	line.addVertices(points.data, points.size);
+	// the builders expect a closed line to end on its first point, as the editor's polylines do
+	if(settings.bIsClosed && points.size > 1 && points.data[points.size - 1] != points.data[0]){
+		line.addVertex(points.data[0]);
+	}
+	line.setClosed(settings.bIsClosed);
+
+	// build straight into the caller's buffers
+	std::swap(builder.ribbonMesh.getVertices(), output.getVertices());
+	std::swap(builder.ribbonMesh.getTexCoords(), output.getTexCoords());
+	builder.generateRibbonMeshFromPolyline(line);
+	builder.moveRibbonMeshInto(output);
+}
+
+void ofxBezierRibbonMeshBuilder::generateRibbonMeshFromPolyline(const ofPolyline & inPoly){
+	simplifyReductionRatio = 1.0;
+	const ofPolyline * line = &inPoly;
+	ofPolyline simplified;
+	if(settings.simplifyTolerance > 0 && inPoly.size() > 2){
+		simplifyReductionRatio = ofxBezierUtility::SimplifyPolyline(inPoly, simplified, settings.simplifyTolerance, settings.simplifyMaxAngle);
+		line = &simplified;
+	}
+	if(line->getVertices().size() > 2){
+		clearSamples();
+		if(settings.bArcLengthSampling){
+			ofxBezierUtility::CalculateArcLengthTangentsAndPoints(*line, points, tangents, settings.sampleSpacing, settings.curvatureWeight);
+		}else{
+			ofxBezierUtility::CalculateInterpolatedTangentsAndPoints(*line, points, tangents, settings.meshLengthPrecisionMultiplier);
 		}
-        int wrapExtent;
-        if(!settings.bIsClosed){
-            wrapExtent = points.size();
-        }
-        else{
-            wrapExtent = points.size() - 1;
-        }
-		for(int i = 0; i < wrapExtent; i++){
-			// Calculate the perpendicular vector
-			ofVec2f perpendicular(-tangents[i].y, tangents[i].x); // Perpendicular vector
-			perpendicular.normalize();
-
-			// Calculate the vertices for both sides
-			ofVec3f currentPoint = points[i];
-			ofVec3f leftVertex = currentPoint - perpendicular * (settings.ribbonWidth * 0.5);
-			ofVec3f rightVertex = currentPoint + perpendicular * (settings.ribbonWidth * 0.5);
-
-			// Add vertices to the mesh in a zigzag manner, suitable for a triangle strip
-			ribbonMesh.addVertex(leftVertex); // Add left vertex
-			ribbonMesh.addTexCoord(ofVec2f(0, segmentDistances[i] / totalLineLength)); // Add left texture coordinate
+		generateRibbonMeshFromSamples();
+	}
+}
+
+void ofxBezierRibbonMeshBuilder::generateRibbonMeshFromSegments(const std::vector <ofxBezierSegmentTree::Segment> & segments){
+	simplifyReductionRatio = 1.0;
+	if(!segments.empty()){
+		clearSamples();
+		ofxBezierUtility::CalculateSegmentTangentsAndPoints(segments, settings, points, tangents);
+		if(points.size() > 1){
+			generateRibbonMeshFromSamples();
+		}
+	}
+}
+
+void ofxBezierRibbonMeshBuilder::clearSamples(){
+	// remember the buffer sizes so we can tell how many of them had to grow
+	capacities = { ribbonMesh.getVertices().capacity(), ribbonMesh.getTexCoords().capacity(), segmentDistances.capacity(), points.capacity(), tangents.capacity() };
+	points.clear();
+	tangents.clear();
+}
 
-			ribbonMesh.addVertex(rightVertex); // Add right vertex
-			ribbonMesh.addTexCoord(ofVec2f(1, segmentDistances[i] / totalLineLength)); // Add left texture coordinate
+void ofxBezierRibbonMeshBuilder::generateRibbonMeshFromSamples(){
+	// Clear mesh (triangle strip)
+	ribbonMesh.clear();
+	ribbonMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+	segmentDistances.clear();
+	totalLineLength = 0;
 
+	ofxBezierUtility::CalculateLineLengths(points, segmentDistances, totalLineLength, settings.roundCap, settings.ribbonWidth);
+
+    if(settings.roundCap && !settings.bIsClosed){
+		//get the poiunts on a hald circle for the cap, the circle centre is the first point and the direction is the tangent. There should be 20 pounts on the half circle.
+		generateCurvedRibbonCap(points[0], tangents[0], true, totalLineLength);
+	}
+    int wrapExtent;
+    if(!settings.bIsClosed){
+        wrapExtent = points.size();
+    }
+    else{
+        wrapExtent = points.size() - 1;
+    }
+	for(int i = 0; i < wrapExtent; i++){
+		// Calculate the perpendicular vector
+		ofVec2f perpendicular(-tangents[i].y, tangents[i].x); // Perpendicular vector
+		perpendicular.normalize();
+
+		// Calculate the vertices for both sides
+		ofVec3f currentPoint = points[i];
+		ofVec3f leftVertex = currentPoint - perpendicular * (settings.ribbonWidth * 0.5);
+		ofVec3f rightVertex = currentPoint + perpendicular * (settings.ribbonWidth * 0.5);
+
+		// Add vertices to the mesh in a zigzag manner, suitable for a triangle strip
+		ribbonMesh.addVertex(leftVertex); // Add left vertex
+		ribbonMesh.addVertex(rightVertex); // Add right vertex
+		if(settings.bMeshTexCoords){
+			ribbonMesh.addTexCoord(ofVec2f(0, segmentDistances[i] / totalLineLength)); // Add left texture coordinate
+			ribbonMesh.addTexCoord(ofVec2f(1, segmentDistances[i] / totalLineLength)); // Add right texture coordinate
 		}
-        
-        if(settings.bIsClosed){
-            ofVec2f perpendicular(-tangents[0].y, tangents[0].x); // Perpendicular vector
-            perpendicular.normalize();
-
-            // Calculate the vertices for both sides
-            ofVec3f currentPoint = points[0];
-            ofVec3f leftVertex = currentPoint - perpendicular * (settings.ribbonWidth * 0.5);
-            ofVec3f rightVertex = currentPoint + perpendicular * (settings.ribbonWidth * 0.5);
-            ribbonMesh.addVertex(leftVertex); // Add left vertex
+	}
+    
+    if(settings.bIsClosed){
+        ofVec2f perpendicular(-tangents[0].y, tangents[0].x); // Perpendicular vector
+        perpendicular.normalize();
+
+        // Calculate the vertices for both sides
+        ofVec3f currentPoint = points[0];
+        ofVec3f leftVertex = currentPoint - perpendicular * (settings.ribbonWidth * 0.5);
+        ofVec3f rightVertex = currentPoint + perpendicular * (settings.ribbonWidth * 0.5);
+        ribbonMesh.addVertex(leftVertex); // Add left vertex
+        ribbonMesh.addVertex(rightVertex); // Add right vertex
+        if(settings.bMeshTexCoords){
             ribbonMesh.addTexCoord(ofVec2f(0, segmentDistances[0] / totalLineLength)); // Add left texture coordinate
-
-            ribbonMesh.addVertex(rightVertex); // Add right vertex
-            ribbonMesh.addTexCoord(ofVec2f(1, segmentDistances[0] / totalLineLength)); // Add left texture coordinate
+            ribbonMesh.addTexCoord(ofVec2f(1, segmentDistances[0] / totalLineLength)); // Add right texture coordinate
         }
+    }
+
+	if(settings.roundCap && !settings.bIsClosed){
+		//get the poiunts on a hald circle for the cap, the circle centre is the first point and the direction is the tangent. There should be 20 pounts on the half circle.
+		generateCurvedRibbonCap(points[points.size() - 1], tangents[tangents.size() - 1], false, totalLineLength);
+	}
 
-		if(settings.roundCap && !settings.bIsClosed){
-			//get the poiunts on a hald circle for the cap, the circle centre is the first point and the direction is the tangent. There should be 20 pounts on the half circle.
-			generateCurvedRibbonCap(points[points.size() - 1], tangents[tangents.size() - 1], false, totalLineLength);
+	std::array <size_t, 5> newCapacities = { ribbonMesh.getVertices().capacity(), ribbonMesh.getTexCoords().capacity(), segmentDistances.capacity(), points.capacity(), tangents.capacity() };
+	bufferGrowths = 0;
+	for(int i = 0; i < newCapacities.size(); i++){
+		if(newCapacities[i] != capacities[i]){
+			bufferGrowths++;
 		}
 	}
 }
 
 void ofxBezierRibbonMeshBuilder::generateCurvedRibbonCap(ofVec3f centre,  ofVec3f tangent, bool forwards, float totalLineLength){
-	// Number of points to create the half circle
-	const int numPointsHalfCircle = 20;
-	float angleStep = 180.0f / numPointsHalfCircle; // Half circle so we step through 180 degrees
+	// The half circle comes from the shared template, backwards caps are the same points negated
+	const ofxBezierCapTemplates::RibbonCap & cap = ofxBezierCapTemplates::GetRibbonCap();
+	float direction = forwards ? 1 : -1;
 
 	ofVec3f circleCenter = centre;
 	ofVec2f circleTangent = tangent.normalize(); // Ensure the tangent is normalized
@@ -100,27 +164,23 @@ void ofxBezierRibbonMeshBuilder::generateCurvedRibbonCap(ofVec3f centre,  ofVec3
 	// Calculate the normal to the tangent
 	ofVec2f circleNormal(-circleTangent.y, circleTangent.x); // Perpendicular to the tangent
 
-	std::vector <ofVec3f> halfCirclePoints;
-	float textureCoordX = 0.5;
-	float textureCoordY = 0; // Top of the curve
-	for(int i = 0; i <= numPointsHalfCircle; ++i){
-		float angle;
-		if(forwards){
-			angle = ofDegToRad(90 + angleStep * i); // Start from -90 degrees to make a semicircle
-		}else{
-			angle = ofDegToRad(angleStep * i - 90); // Start from -90 degrees to make a semicircle
-		}
+	for(int i = 0; i < cap.cosines.size(); ++i){
+		float cosAngle = cap.cosines[i] * direction;
+		float sinAngle = cap.sines[i] * direction;
 
 		// Calculate the point on the circle using cosine and sine for the respective axes
-		ofVec3f circlePoint = circleCenter + circleTangent * cos(angle) * (settings.ribbonWidth * 0.5) + circleNormal * sin(angle) * (settings.ribbonWidth * 0.5);
+		ofVec3f circlePoint = circleCenter + circleTangent * cosAngle * (settings.ribbonWidth * 0.5) + circleNormal * sinAngle * (settings.ribbonWidth * 0.5);
 
 		// Add the calculated point to the half circle points vector
 		ribbonMesh.addVertex(circlePoint);
 		ribbonMesh.addVertex(circleCenter);
 
+		if(!settings.bMeshTexCoords){
+			continue;
+		}
 		// Now calculate distances relative to the equator
-		float distanceToEquator = settings.ribbonWidth * 0.5  * 0.5  + ((settings.ribbonWidth * 0.5  * 0.5) * sin(angle));
-		float distanceToEquatorPerp = abs((settings.ribbonWidth * 0.5) * cos(angle));
+		float distanceToEquator = settings.ribbonWidth * 0.5  * 0.5  + ((settings.ribbonWidth * 0.5  * 0.5) * sinAngle);
+		float distanceToEquatorPerp = abs((settings.ribbonWidth * 0.5) * cosAngle);
 		float texCoordX = distanceToEquator / (settings.ribbonWidth * 0.5); // Normalize between 0 and 1
 
 		float texCoordY;
@@ -7,13 +7,14 @@
 
 #pragma once
 #include "ofMain.h"
-#include "ofxBezierEditorSettings.h"
+#include "ofxBezierMeshSettings.h"
 #include "draggableVertex.h"
 #include "ofxBezierEvents.h"
+#include "ofxBezierSegmentTree.h"
 
 class ofxBezierRibbonMeshBuilder {
 	public:
-		ofxBezierRibbonMeshBuilder(ofxBezierEditorSettings & settings);
+		ofxBezierRibbonMeshBuilder(ofxBezierMeshSettings & settings);
 
 		~ofxBezierRibbonMeshBuilder();
 
@@ -21,18 +22,50 @@ class ofxBezierRibbonMeshBuilder {
 		ofVboMesh getRibbonMesh(){
 			return ribbonMesh;
 		}
-		ofVboMesh getRibbonMeshFromPolyline(ofPolyline inPoly);
-		void generateRibbonMeshFromPolyline(ofPolyline inPoly);
+		ofVboMesh getRibbonMeshFromPolyline(const ofPolyline & inPoly);
+		void generateRibbonMeshFromPolyline(const ofPolyline & inPoly);
+		// Samples the cubic segments directly, with exact tangents from their derivative. The simplify
+		// tolerance does not apply, there is no polyline to simplify.
+		void generateRibbonMeshFromSegments(const std::vector <ofxBezierSegmentTree::Segment> & segments);
+
+		// Hands the last generated mesh over to target without copying it
+		void moveRibbonMeshInto(ofMesh & target);
+
+		// Meshes points with settings into output and touches nothing else, so strokes can be meshed from
+		// several threads at once. Every call copies the points into an ofPolyline and makes a builder of
+		// its own, so only output's buffers are reused and the scratch is allocated again each time.
+		// settings.bIsClosed says whether the points form a loop, the first point is added again at the
+		// end if the last one isn't already the same.
+		static void BuildRibbonMesh(const ofxBezierPointSpan & points, const ofxBezierMeshSettings & settings, ofMesh & output);
+
+		// Stats of the last build, used by the profiler
+		// how many of the builder's reused buffers (mesh arrays and samples) had to grow. Not a count of heap
+		// allocations, a buffer can reallocate more than once while it grows
+		size_t getBufferGrowths(){
+			return bufferGrowths;
+		}
+		float getSimplifyReductionRatio(){
+			return simplifyReductionRatio;
+		}
 
 
 	private:
 		ofVboMesh ribbonMesh;
 		void generateCurvedRibbonCap(ofVec3f centre,  ofVec3f tangent, bool forwards, float totalLineLength);
-		ofxBezierEditorSettings & settings;
+		void clearSamples();
+		// builds the mesh from points and tangents
+		void generateRibbonMeshFromSamples();
+		ofxBezierMeshSettings & settings;
 		void onTriggerUpdate(TriggerUpdateEventArgs & args);
 
+		vector <ofVec3f> points;
+		vector <ofVec3f> tangents;
 		std::vector <float> segmentDistances;
 
 		float totalLineLength = 0;
 
+		size_t bufferGrowths = 0;
+		std::array <size_t, 5> capacities;
+		float simplifyReductionRatio = 1.0;
+
 };
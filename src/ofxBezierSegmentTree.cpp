@@ -0,0 +1,358 @@
+//
+//  ofxBezierSegmentTree.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierSegmentTree.h"
+#include "ofxBezierUtility.h"
+
+namespace {
+	// signed crossings of the horizontal through y by anything that runs from a to b, as long as it
+	// stays right of the point. Half open, so a run ending exactly on y is counted once.
+	int getCrossing(float ay, float by, float y){
+		return (ay <= y ? 1 : 0) - (by <= y ? 1 : 0);
+	}
+
+	float distanceToRectangle(const ofRectangle & rect, const glm::vec2 & point){
+		float dx = std::max(std::max(rect.getMinX() - point.x, 0.0f), point.x - rect.getMaxX());
+		float dy = std::max(std::max(rect.getMinY() - point.y, 0.0f), point.y - rect.getMaxY());
+		return sqrt(dx * dx + dy * dy);
+	}
+}
+
+ofxBezierSegmentTree::ofxBezierSegmentTree(){
+}
+
+void ofxBezierSegmentTree::clear(){
+	segments.clear();
+	nodes.clear();
+	parents.clear();
+	leaves.clear();
+}
+
+void ofxBezierSegmentTree::build(const std::vector <draggableVertex> & vertices, const std::vector <draggableVertex> & cp1, const std::vector <draggableVertex> & cp2,
+								 bool closed, const std::vector <int> & polylineStarts, int polylineSize){
+	clear();
+	if(vertices.size() < 2){
+		return;
+	}
+
+	int segmentCount = closed ? vertices.size() : vertices.size() - 1;
+	segments.resize(segmentCount);
+	for(int i = 0; i < segmentCount; i++){
+		setSegment(i, vertices, cp1, cp2, polylineStarts, polylineSize);
+	}
+
+	nodes.reserve(2 * (segmentCount / leafSize + 1));
+	parents.reserve(nodes.capacity());
+	buildNode(0, segmentCount, -1);
+}
+
+int ofxBezierSegmentTree::update(const std::vector <draggableVertex> & vertices, const std::vector <draggableVertex> & cp1, const std::vector <draggableVertex> & cp2,
+								 bool closed, const std::vector <int> & polylineStarts, int polylineSize){
+	int segmentCount = vertices.size() < 2 ? 0 : (closed ? vertices.size() : vertices.size() - 1);
+	if(segmentCount != segments.size() || segmentCount == 0){
+		build(vertices, cp1, cp2, closed, polylineStarts, polylineSize);
+		return segments.size();
+	}
+
+	int changed = 0;
+	dirtyLeaves.assign(leaves.size(), false);
+	for(int i = 0; i < segmentCount; i++){
+		if(setSegment(i, vertices, cp1, cp2, polylineStarts, polylineSize)){
+			dirtyLeaves[i / leafSize] = true;
+			changed++;
+		}
+	}
+	if(changed == 0){
+		return 0;
+	}
+
+	// refit the changed leaves and mark everything above them
+	dirtyNodes.assign(nodes.size(), false);
+	for(int i = 0; i < leaves.size(); i++){
+		if(!dirtyLeaves[i]){
+			continue;
+		}
+		refitLeaf(leaves[i]);
+		for(int node = parents[leaves[i]]; node >= 0 && !dirtyNodes[node]; node = parents[node]){
+			dirtyNodes[node] = true;
+		}
+	}
+	// children always come after their parent, so walking backwards visits them first
+	for(int i = nodes.size() - 1; i >= 0; i--){
+		if(dirtyNodes[i]){
+			nodes[i].bounds = nodes[nodes[i].left].bounds;
+			nodes[i].bounds.growToInclude(nodes[nodes[i].right].bounds);
+		}
+	}
+	return changed;
+}
+
+bool ofxBezierSegmentTree::setSegment(int index, const std::vector <draggableVertex> & vertices, const std::vector <draggableVertex> & cp1, const std::vector <draggableVertex> & cp2,
+									  const std::vector <int> & polylineStarts, int polylineSize){
+	// the segment into vertex i + 1 uses that vertex's control points, the closing one uses slot 0
+	int next = (index + 1) % vertices.size();
+	Segment & segment = segments[index];
+
+	if(index < polylineStarts.size()){
+		segment.polylineFirst = polylineStarts[index];
+		segment.polylineLast = (index + 1 < polylineStarts.size()) ? polylineStarts[index + 1] : polylineSize - 1;
+	}
+
+	glm::vec2 p0 = vertices[index].pos;
+	glm::vec2 c1 = cp1[next].pos;
+	glm::vec2 c2 = cp2[next].pos;
+	glm::vec2 p1 = vertices[next].pos;
+	if(p0 == segment.p0 && c1 == segment.c1 && c2 == segment.c2 && p1 == segment.p1){
+		return false;
+	}
+	segment.p0 = p0;
+	segment.c1 = c1;
+	segment.c2 = c2;
+	segment.p1 = p1;
+	segment.bounds = ofxBezierUtility::GetSegmentBounds(p0, c1, c2, p1);
+	segment.revision = ++revisionCounter;
+	return true;
+}
+
+int ofxBezierSegmentTree::buildNode(int first, int count, int parent){
+	int index = nodes.size();
+	nodes.push_back(Node());
+	parents.push_back(parent);
+	nodes[index].first = first;
+	nodes[index].count = count;
+
+	if(count <= leafSize){
+		leaves.push_back(index);
+		refitLeaf(index);
+		return index;
+	}
+
+	// split in the middle of the run, rounded to whole leaves so leaf i always starts at segment i * leafSize
+	int half = ((count / 2 + leafSize - 1) / leafSize) * leafSize;
+	int left = buildNode(first, half, index);
+	int right = buildNode(first + half, count - half, index);
+	// nodes may have moved while the children were added
+	nodes[index].left = left;
+	nodes[index].right = right;
+	nodes[index].bounds = nodes[left].bounds;
+	nodes[index].bounds.growToInclude(nodes[right].bounds);
+	return index;
+}
+
+void ofxBezierSegmentTree::refitLeaf(int index){
+	Node & node = nodes[index];
+	node.bounds = segments[node.first].bounds;
+	for(int i = node.first + 1; i < node.first + node.count; i++){
+		node.bounds.growToInclude(segments[i].bounds);
+	}
+}
+
+void ofxBezierSegmentTree::refit(){
+	// children always come after their parent, so walking backwards visits them first
+	for(int i = nodes.size() - 1; i >= 0; i--){
+		Node & node = nodes[i];
+		if(node.isLeaf()){
+			refitLeaf(i);
+		}else{
+			node.bounds = nodes[node.left].bounds;
+			node.bounds.growToInclude(nodes[node.right].bounds);
+		}
+	}
+}
+
+void ofxBezierSegmentTree::querySegments(const ofRectangle & rect, std::vector <int> & segmentIndices) const {
+	std::vector <int> leaves;
+	queryLeaves(rect, leaves);
+	for(int leaf : leaves){
+		const Node & node = nodes[leaf];
+		for(int i = node.first; i < node.first + node.count; i++){
+			if(segments[i].bounds.intersects(rect)){
+				segmentIndices.push_back(i);
+			}
+		}
+	}
+}
+
+void ofxBezierSegmentTree::queryLeaves(const ofRectangle & rect, std::vector <int> & nodeIndices) const {
+	if(nodes.empty()){
+		return;
+	}
+	int stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while(stackSize > 0){
+		const Node & node = nodes[stack[--stackSize]];
+		if(!node.bounds.intersects(rect)){
+			continue;
+		}
+		if(node.isLeaf()){
+			nodeIndices.push_back(&node - &nodes[0]);
+		}else{
+			// right first so the left child is popped first and leaves come out in segment order
+			stack[stackSize++] = node.right;
+			stack[stackSize++] = node.left;
+		}
+	}
+}
+
+ofxBezierSegmentTree::ClosestPoint ofxBezierSegmentTree::closestPoint(const glm::vec2 & point, float maxDistance) const {
+	ClosestPoint best;
+	best.distance = maxDistance;
+	closestPoint(point, best);
+	return best;
+}
+
+void ofxBezierSegmentTree::closestPoints(const std::vector <glm::vec2> & points, std::vector <ClosestPoint> & results, float maxDistance) const {
+	results.resize(points.size());
+	int lastSegment = -1;
+	for(int i = 0; i < points.size(); i++){
+		ClosestPoint & best = results[i];
+		best = ClosestPoint();
+		best.distance = maxDistance;
+		// the previous answer is usually close, which gives a tight bound to prune with from the start
+		if(lastSegment >= 0){
+			projectOnSegment(lastSegment, points[i], best);
+		}
+		closestPoint(points[i], best);
+		lastSegment = best.segment;
+	}
+}
+
+void ofxBezierSegmentTree::closestPoint(const glm::vec2 & point, ClosestPoint & best) const {
+	if(nodes.empty()){
+		return;
+	}
+	int stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while(stackSize > 0){
+		const Node & node = nodes[stack[--stackSize]];
+		if(distanceToRectangle(node.bounds, point) >= best.distance){
+			continue;
+		}
+		if(node.isLeaf()){
+			for(int i = node.first; i < node.first + node.count; i++){
+				if(i != best.segment && distanceToRectangle(segments[i].bounds, point) < best.distance){
+					projectOnSegment(i, point, best);
+				}
+			}
+		}else{
+			// push the further child first so the nearer one is searched first and tightens the bound
+			float leftDistance = distanceToRectangle(nodes[node.left].bounds, point);
+			float rightDistance = distanceToRectangle(nodes[node.right].bounds, point);
+			if(leftDistance < rightDistance){
+				stack[stackSize++] = node.right;
+				stack[stackSize++] = node.left;
+			}else{
+				stack[stackSize++] = node.left;
+				stack[stackSize++] = node.right;
+			}
+		}
+	}
+}
+
+void ofxBezierSegmentTree::projectOnSegment(int index, const glm::vec2 & point, ClosestPoint & best) const {
+	const Segment & segment = segments[index];
+	float t;
+	float distance = ofxBezierUtility::ClosestPointOnSegment(segment.p0, segment.c1, segment.c2, segment.p1, point, t);
+	if(distance < best.distance){
+		best.segment = index;
+		best.t = t;
+		best.distance = distance;
+		best.point = ofxBezierUtility::EvaluateSegment(segment.p0, segment.c1, segment.c2, segment.p1, t);
+	}
+}
+
+int ofxBezierSegmentTree::getWindingNumber(const glm::vec2 & point) const {
+	if(nodes.empty()){
+		return 0;
+	}
+	int winding = 0;
+	int stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while(stackSize > 0){
+		const Node & node = nodes[stack[--stackSize]];
+		if(node.bounds.getMaxX() < point.x || node.bounds.getMinY() > point.y || node.bounds.getMaxY() < point.y){
+			continue;
+		}
+		// a node is a run of consecutive segments, if it is all right of the point only its ends matter
+		if(node.bounds.getMinX() > point.x){
+			winding += getCrossing(segments[node.first].p0.y, segments[node.first + node.count - 1].p1.y, point.y);
+			continue;
+		}
+		if(!node.isLeaf()){
+			stack[stackSize++] = node.left;
+			stack[stackSize++] = node.right;
+			continue;
+		}
+		for(int i = node.first; i < node.first + node.count; i++){
+			const Segment & segment = segments[i];
+			if(segment.bounds.getMaxX() < point.x || segment.bounds.getMinY() > point.y || segment.bounds.getMaxY() < point.y){
+				continue;
+			}
+			if(segment.bounds.getMinX() > point.x){
+				winding += getCrossing(segment.p0.y, segment.p1.y, point.y);
+			}else{
+				winding += getSegmentWinding(segment.p0, segment.c1, segment.c2, segment.p1, point, 0);
+			}
+		}
+	}
+	// open curves are closed with a straight line back to the start
+	const glm::vec2 & last = segments.back().p1;
+	const glm::vec2 & first = segments.front().p0;
+	if(last != first && (last.y <= point.y) != (first.y <= point.y)){
+		float x = ofLerp(last.x, first.x, (point.y - last.y) / (first.y - last.y));
+		if(x > point.x){
+			winding += getCrossing(last.y, first.y, point.y);
+		}
+	}
+	return winding;
+}
+
+void ofxBezierSegmentTree::getWindingNumbers(const std::vector <glm::vec2> & points, std::vector <int> & windingNumbers) const {
+	windingNumbers.resize(points.size());
+	ofRectangle bounds = getBounds();
+	for(int i = 0; i < points.size(); i++){
+		// most points of a batch are usually nowhere near the shape
+		if(nodes.empty() || points[i].x < bounds.getMinX() || points[i].x > bounds.getMaxX() || points[i].y < bounds.getMinY() || points[i].y > bounds.getMaxY()){
+			windingNumbers[i] = 0;
+		}else{
+			windingNumbers[i] = getWindingNumber(points[i]);
+		}
+	}
+}
+
+int ofxBezierSegmentTree::getSegmentWinding(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, const glm::vec2 & point, int depth) const {
+	// the piece lies in the box of its control points
+	float minX = std::min(std::min(p0.x, c1.x), std::min(c2.x, p1.x));
+	float maxX = std::max(std::max(p0.x, c1.x), std::max(c2.x, p1.x));
+	float minY = std::min(std::min(p0.y, c1.y), std::min(c2.y, p1.y));
+	float maxY = std::max(std::max(p0.y, c1.y), std::max(c2.y, p1.y));
+	if(maxX < point.x || minY > point.y || maxY < point.y){
+		return 0;
+	}
+	if(minX > point.x){
+		return getCrossing(p0.y, p1.y, point.y);
+	}
+	// small enough to treat as its chord
+	if(depth >= 24 || (maxX - minX < 1e-4 && maxY - minY < 1e-4)){
+		if((p0.y <= point.y) == (p1.y <= point.y)){
+			return 0;
+		}
+		float x = ofLerp(p0.x, p1.x, (point.y - p0.y) / (p1.y - p0.y));
+		return x > point.x ? getCrossing(p0.y, p1.y, point.y) : 0;
+	}
+	glm::vec2 firstC1, firstC2, split, secondC1, secondC2;
+	ofxBezierUtility::SplitSegment(p0, c1, c2, p1, 0.5, firstC1, firstC2, split, secondC1, secondC2);
+	return getSegmentWinding(p0, firstC1, firstC2, split, point, depth + 1) + getSegmentWinding(split, secondC1, secondC2, p1, point, depth + 1);
+}
+
+ofRectangle ofxBezierSegmentTree::getBounds() const {
+	if(nodes.empty()){
+		return ofRectangle();
+	}
+	return nodes[0].bounds;
+}
@@ -0,0 +1,124 @@
+//
+//  ofxBezierSegmentTree.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "draggableVertex.h"
+
+// A bounding volume hierarchy over the cubic segments of a bezier.
+// Segment i runs from vertex i to vertex i + 1 (the closing segment of a closed curve
+// runs from the last vertex back to vertex 0). Neighbouring segments are close to each
+// other, so the tree splits the segment list in index order: every leaf is a run of
+// consecutive segments, which is also what we cull and draw as one chunk.
+class ofxBezierSegmentTree {
+	public:
+		struct Segment {
+			glm::vec2 p0;
+			glm::vec2 c1;
+			glm::vec2 c2;
+			glm::vec2 p1;
+			ofRectangle bounds;
+			// vertices of the tessellated polyline that belong to this segment, both included
+			int polylineFirst = 0;
+			int polylineLast = 0;
+			// bumped every time the points change, so caches built from a segment can tell they are stale
+			unsigned int revision = 0;
+		};
+
+		struct Node {
+			ofRectangle bounds;
+			// children, -1 for leaves
+			int left = -1;
+			int right = -1;
+			// the run of segments below this node
+			int first = 0;
+			int count = 0;
+			bool isLeaf() const {
+				return left < 0;
+			}
+		};
+
+		// Result of a nearest point query, segment is -1 if nothing was found
+		struct ClosestPoint {
+			int segment = -1;
+			float t = 0;
+			float distance = std::numeric_limits <float>::max();
+			glm::vec2 point;
+		};
+
+		ofxBezierSegmentTree();
+
+		// segments per leaf, also the culling granularity
+		void setLeafSize(int size){
+			leafSize = std::max(size, 1);
+		}
+		int getLeafSize() const {
+			return leafSize;
+		}
+
+		// polylineStarts holds the polyline index each segment starts at, polylineSize closes the last one
+		void build(const std::vector <draggableVertex> & vertices, const std::vector <draggableVertex> & cp1, const std::vector <draggableVertex> & cp2,
+				   bool closed, const std::vector <int> & polylineStarts, int polylineSize);
+		void clear();
+
+		// Like build, but when the number of segments is unchanged only the segments whose points moved get
+		// new bounds, and only the nodes above them are refitted. Returns how many segments changed.
+		int update(const std::vector <draggableVertex> & vertices, const std::vector <draggableVertex> & cp1, const std::vector <draggableVertex> & cp2,
+				   bool closed, const std::vector <int> & polylineStarts, int polylineSize);
+
+		// Recomputes the node bounds bottom up after segments changed
+		void refit();
+
+		// Indices of the segments whose bounds overlap rect
+		void querySegments(const ofRectangle & rect, std::vector <int> & segmentIndices) const;
+		// Indices of the leaves whose bounds overlap rect, in segment order
+		void queryLeaves(const ofRectangle & rect, std::vector <int> & nodeIndices) const;
+
+		// Nearest point on the curve. Nodes are visited closest first and skipped once they are
+		// further away than the best segment so far, so only a handful of segments are ever projected.
+		ClosestPoint closestPoint(const glm::vec2 & point, float maxDistance = std::numeric_limits <float>::max()) const;
+		// One result per point. Each query starts from the previous result's segment, which makes
+		// runs of nearby points (a dragged tool, a stroke being snapped) much cheaper.
+		void closestPoints(const std::vector <glm::vec2> & points, std::vector <ClosestPoint> & results, float maxDistance = std::numeric_limits <float>::max()) const;
+
+		// Winding number of the curve around point, counting the segments as a closed loop.
+		// Runs of segments entirely to the right of the point only count their end points and
+		// runs that can't cross the point's horizontal are skipped, so most of the tree is never opened.
+		int getWindingNumber(const glm::vec2 & point) const;
+		void getWindingNumbers(const std::vector <glm::vec2> & points, std::vector <int> & windingNumbers) const;
+
+		const std::vector <Segment> & getSegments() const {
+			return segments;
+		}
+		const std::vector <Node> & getNodes() const {
+			return nodes;
+		}
+		// bounds of the whole curve, empty when there are no segments
+		ofRectangle getBounds() const;
+		bool empty() const {
+			return segments.empty();
+		}
+
+	private:
+		int buildNode(int first, int count, int parent);
+		// fills in points, bounds and polyline range, returns false if the points did not move
+		bool setSegment(int index, const std::vector <draggableVertex> & vertices, const std::vector <draggableVertex> & cp1, const std::vector <draggableVertex> & cp2,
+						const std::vector <int> & polylineStarts, int polylineSize);
+		void refitLeaf(int node);
+		void closestPoint(const glm::vec2 & point, ClosestPoint & best) const;
+		void projectOnSegment(int index, const glm::vec2 & point, ClosestPoint & best) const;
+		int getSegmentWinding(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, const glm::vec2 & point, int depth) const;
+
+		std::vector <Segment> segments;
+		std::vector <Node> nodes;
+		std::vector <int> parents;
+		// leaves in segment order, leaf i holds the segments from i * leafSize
+		std::vector <int> leaves;
+		std::vector <bool> dirtyLeaves;
+		std::vector <bool> dirtyNodes;
+		int leafSize = 8;
+		unsigned int revisionCounter = 0;
+};
@@ -0,0 +1,250 @@
+//
+//  ofxBezierStrokeBuilder.cpp
+//  ofxBezierEditor
+//
+
+#include "ofxBezierStrokeBuilder.h"
+
+ofxBezierStrokeBuilder::ofxBezierStrokeBuilder(ofxBezierMeshSettings & settings) : settings(settings){
+	mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+}
+
+void ofxBezierStrokeBuilder::clear(){
+	points.clear();
+	distances.clear();
+	// clearing keeps the capacity, the next stroke reuses it
+	mesh.clear();
+	mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+	stableVertices = 0;
+	bHasStableRing = false;
+	bHasPreviousRing = false;
+	dirtyStart = 0;
+	rewrittenVertices = 0;
+}
+
+bool ofxBezierStrokeBuilder::addPoint(const glm::vec3 & point){
+	if(!points.empty()){
+		float distance = glm::distance(point, points.back());
+		if(distance <= 0 || distance < minimumSpacing){
+			return false;
+		}
+		distances.push_back(distances.back() + distance);
+	}else{
+		bool tube = settings.bUseTubeMesh;
+		if(tube != bTube){
+			// the buffers have to be bound again with or without normals
+			bTube = tube;
+			bufferCapacity = 0;
+		}
+		capTemplate = &ofxBezierCapTemplates::GetTubeCap(settings.tubeResolution);
+		float capLength = bTube ? settings.tubeRadius : settings.ribbonWidth * 0.5;
+		distances.push_back(settings.roundCap ? capLength : 0);
+	}
+	points.push_back(point);
+	rewrittenVertices = 0;
+	if(points.size() < 2){
+		// one point has no direction yet
+		return true;
+	}
+
+	// throw away the tail of the last sample...
+	size_t firstRewritten = stableVertices;
+	mesh.getVertices().resize(stableVertices);
+	mesh.getTexCoords().resize(stableVertices);
+	if(bTube){
+		mesh.getNormals().resize(stableVertices);
+		previousRing = lastStableRing;
+		bHasPreviousRing = bHasStableRing;
+	}
+	dirtyStart = std::min(dirtyStart, stableVertices);
+
+	// ...the sample before the new one now has both neighbours, so it is final...
+	if(points.size() == 2){
+		appendStartCap();
+		appendSample(0);
+	}else{
+		appendSample(points.size() - 2);
+	}
+	stableVertices = mesh.getNumVertices();
+	if(bTube){
+		lastStableRing = previousRing;
+		bHasStableRing = bHasPreviousRing;
+	}
+
+	// ...and the new one gets a tail that lasts until the next sample
+	appendSample(points.size() - 1);
+	appendEndCap();
+
+	rewrittenVertices = mesh.getNumVertices() - firstRewritten;
+	return true;
+}
+
+glm::vec3 ofxBezierStrokeBuilder::getTangent(size_t index){
+	if(index == 0){
+		return glm::normalize(points[1] - points[0]);
+	}
+	glm::vec3 incoming = glm::normalize(points[index] - points[index - 1]);
+	if(index == points.size() - 1){
+		return incoming;
+	}
+	glm::vec3 outgoing = glm::normalize(points[index + 1] - points[index]);
+	glm::vec3 tangent = incoming + outgoing;
+	if(glm::length2(tangent) < 1e-8){
+		// the stroke doubles back on itself here
+		return outgoing;
+	}
+	return glm::normalize(tangent);
+}
+
+void ofxBezierStrokeBuilder::appendSample(size_t index){
+	const glm::vec3 & point = points[index];
+	glm::vec3 tangent = getTangent(index);
+	if(bTube){
+		appendTubeRing(point, tangent, settings.tubeRadius, distances[index], point);
+		return;
+	}
+	glm::vec3 perpendicular(-tangent.y, tangent.x, 0);
+	float halfWidth = settings.ribbonWidth * 0.5;
+	mesh.addVertex(point - perpendicular * halfWidth);
+	mesh.addTexCoord(glm::vec2(0, distances[index]));
+	mesh.addVertex(point + perpendicular * halfWidth);
+	mesh.addTexCoord(glm::vec2(1, distances[index]));
+}
+
+void ofxBezierStrokeBuilder::appendStartCap(){
+	const glm::vec3 & centre = points[0];
+	glm::vec3 tangent = getTangent(0);
+	if(!bTube){
+		if(settings.roundCap){
+			appendRibbonCap(centre, tangent, true, distances[0]);
+		}
+		return;
+	}
+	float radius = settings.tubeRadius;
+	if(settings.roundCap){
+		// from the pole to the ring before the equator, the first sample is the equator
+		int pole = capTemplate->hemisphereOffsets.size() - 1;
+		for(int i = pole; i >= 1; i--){
+			float offset = capTemplate->hemisphereOffsets[i] * radius;
+			appendTubeRing(centre - tangent * offset, tangent, capTemplate->hemisphereRadii[i] * radius, radius - offset, centre);
+		}
+	}else{
+		glm::vec3 discNormal = -tangent;
+		for(int i = 0; i < settings.tubeResolution; i++){
+			appendTubeRing(centre, tangent, radius * i / settings.tubeResolution, 0, centre, &discNormal);
+		}
+	}
+}
+
+void ofxBezierStrokeBuilder::appendEndCap(){
+	const glm::vec3 & centre = points.back();
+	glm::vec3 tangent = getTangent(points.size() - 1);
+	float v = distances.back();
+	if(!bTube){
+		if(settings.roundCap){
+			appendRibbonCap(centre, tangent, false, v);
+		}
+		return;
+	}
+	float radius = settings.tubeRadius;
+	if(settings.roundCap){
+		int pole = capTemplate->hemisphereOffsets.size() - 1;
+		for(int i = 1; i <= pole; i++){
+			float offset = capTemplate->hemisphereOffsets[i] * radius;
+			appendTubeRing(centre + tangent * offset, tangent, capTemplate->hemisphereRadii[i] * radius, v + offset, centre);
+		}
+	}else{
+		for(int i = settings.tubeResolution - 1; i >= 0; i--){
+			appendTubeRing(centre, tangent, radius * i / settings.tubeResolution, v, centre, &tangent);
+		}
+	}
+}
+
+void ofxBezierStrokeBuilder::appendRibbonCap(const glm::vec3 & centre, const glm::vec3 & tangent, bool forwards, float v){
+	// same fan as ofxBezierRibbonMeshBuilder's caps, with v in stroke units
+	const ofxBezierCapTemplates::RibbonCap & cap = ofxBezierCapTemplates::GetRibbonCap();
+	float direction = forwards ? 1 : -1;
+	float halfWidth = settings.ribbonWidth * 0.5;
+	glm::vec3 normal(-tangent.y, tangent.x, 0);
+	for(int i = 0; i < cap.cosines.size(); i++){
+		float cosAngle = cap.cosines[i] * direction;
+		float sinAngle = cap.sines[i] * direction;
+		mesh.addVertex(centre + tangent * cosAngle * halfWidth + normal * sinAngle * halfWidth);
+		mesh.addVertex(centre);
+
+		float along = std::abs(cosAngle) * halfWidth;
+		mesh.addTexCoord(glm::vec2(0.5 + 0.5 * sinAngle, forwards ? v - along : v + along));
+		mesh.addTexCoord(glm::vec2(0.5, v));
+	}
+}
+
+void ofxBezierStrokeBuilder::appendTubeRing(const glm::vec3 & centre, const glm::vec3 & tangent, float radius, float v, const glm::vec3 & sphereCentre, const glm::vec3 * discNormal){
+	glm::vec3 normal(tangent.y, -tangent.x, 0);
+	glm::vec3 binormal = glm::cross(tangent, normal);
+	ring.vertices.clear();
+	ring.normals.clear();
+	ring.texCoords.clear();
+	for(int j = 0; j <= settings.tubeResolution; j++){
+		glm::vec3 around = normal * capTemplate->ringCos[j] + binormal * capTemplate->ringSin[j];
+		glm::vec3 vertex = centre + around * radius;
+		ring.vertices.push_back(vertex);
+		if(discNormal){
+			ring.normals.push_back(*discNormal);
+		}else{
+			glm::vec3 fromCentre = vertex - sphereCentre;
+			ring.normals.push_back(glm::length2(fromCentre) > 1e-12 ? glm::normalize(fromCentre) : around);
+		}
+		ring.texCoords.push_back(glm::vec2(j / static_cast <float>(settings.tubeResolution), v));
+	}
+
+	// the band from the previous ring to this one, two vertices at a time like the tube builder
+	if(bHasPreviousRing){
+		for(int j = 0; j < ring.vertices.size(); j++){
+			mesh.addVertex(previousRing.vertices[j]);
+			mesh.addVertex(ring.vertices[j]);
+			mesh.addNormal(previousRing.normals[j]);
+			mesh.addNormal(ring.normals[j]);
+			mesh.addTexCoord(previousRing.texCoords[j]);
+			mesh.addTexCoord(ring.texCoords[j]);
+		}
+	}
+	std::swap(previousRing, ring);
+	bHasPreviousRing = true;
+}
+
+void ofxBezierStrokeBuilder::uploadChanges(){
+	size_t count = mesh.getNumVertices();
+	if(count > bufferCapacity){
+		// grow by doubling so a long stroke only reallocates a handful of times
+		bufferCapacity = std::max(count, std::max(bufferCapacity * 2, (size_t)1024));
+		vertexBuffer.allocate(bufferCapacity * sizeof(glm::vec3), GL_DYNAMIC_DRAW);
+		texCoordBuffer.allocate(bufferCapacity * sizeof(glm::vec2), GL_DYNAMIC_DRAW);
+		vbo.setVertexBuffer(vertexBuffer, 3, sizeof(glm::vec3));
+		vbo.setTexCoordBuffer(texCoordBuffer, sizeof(glm::vec2));
+		if(bTube){
+			normalBuffer.allocate(bufferCapacity * sizeof(glm::vec3), GL_DYNAMIC_DRAW);
+			vbo.setNormalBuffer(normalBuffer, sizeof(glm::vec3));
+		}else{
+			vbo.disableNormals();
+		}
+		bufferAllocationCount++;
+		dirtyStart = 0;
+	}
+	if(dirtyStart < count){
+		size_t changed = count - dirtyStart;
+		vertexBuffer.updateData(dirtyStart * sizeof(glm::vec3), changed * sizeof(glm::vec3), mesh.getVertices().data() + dirtyStart);
+		texCoordBuffer.updateData(dirtyStart * sizeof(glm::vec2), changed * sizeof(glm::vec2), mesh.getTexCoords().data() + dirtyStart);
+		if(bTube){
+			normalBuffer.updateData(dirtyStart * sizeof(glm::vec3), changed * sizeof(glm::vec3), mesh.getNormals().data() + dirtyStart);
+		}
+	}
+	dirtyStart = count;
+}
+
+void ofxBezierStrokeBuilder::draw(){
+	if(mesh.getNumVertices() == 0){
+		return;
+	}
+	uploadChanges();
+	vbo.draw(GL_TRIANGLE_STRIP, 0, mesh.getNumVertices());
+}
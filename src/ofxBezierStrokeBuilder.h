@@ -0,0 +1,97 @@
+//
+//  ofxBezierStrokeBuilder.h
+//  ofxBezierEditor
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxBezierMeshSettings.h"
+#include "ofxBezierCapTemplates.h"
+
+// Meshes a stroke while it is being drawn. Every new sample appends its ribbon pair or tube ring
+// to the mesh, only the last sample and the end cap are thrown away and rebuilt (their tangent
+// changes with each new sample). The vertex buffer grows by doubling and only the changed tail
+// is uploaded, so a sample costs the same however long the stroke already is.
+// A tube is built when the settings use the tube mesh, a ribbon otherwise. Strokes are always open,
+// v texture coordinates are the length along the stroke in stroke units.
+class ofxBezierStrokeBuilder {
+	public:
+		ofxBezierStrokeBuilder(ofxBezierMeshSettings & settings);
+
+		// Starts a new stroke, the buffers are kept for the next one
+		void clear();
+		// Returns false if the sample was closer than the minimum spacing to the last one and skipped
+		bool addPoint(const glm::vec3 & point);
+		void setMinimumSpacing(float spacing){
+			minimumSpacing = spacing;
+		}
+		float getMinimumSpacing(){
+			return minimumSpacing;
+		}
+
+		const std::vector <glm::vec3> & getPoints() const {
+			return points;
+		}
+		const ofMesh & getMesh() const {
+			return mesh;
+		}
+		// Uploads what changed since the last draw and draws the stroke
+		void draw();
+
+		// vertices written by the last addPoint, the appended ones and the rebuilt tail
+		size_t getRewrittenVertexCount(){
+			return rewrittenVertices;
+		}
+		// how many times the vertex buffer had to grow
+		size_t getBufferAllocationCount(){
+			return bufferAllocationCount;
+		}
+
+	private:
+		struct Ring {
+			std::vector <glm::vec3> vertices;
+			std::vector <glm::vec3> normals;
+			std::vector <glm::vec2> texCoords;
+		};
+
+		glm::vec3 getTangent(size_t index);
+		void appendSample(size_t index);
+		void appendStartCap();
+		void appendEndCap();
+		void appendRibbonCap(const glm::vec3 & centre, const glm::vec3 & tangent, bool forwards, float v);
+		// normals point away from sphereCentre, or are discNormal if there is one
+		void appendTubeRing(const glm::vec3 & centre, const glm::vec3 & tangent, float radius, float v, const glm::vec3 & sphereCentre, const glm::vec3 * discNormal = nullptr);
+		void uploadChanges();
+
+		ofxBezierMeshSettings & settings;
+		// decided at the first sample, so a stroke doesn't change kind halfway
+		bool bTube = false;
+		const ofxBezierCapTemplates::TubeCap * capTemplate = nullptr;
+		float minimumSpacing = 1.0;
+
+		std::vector <glm::vec3> points;
+		// length along the stroke at every sample, the start cap included
+		std::vector <float> distances;
+
+		ofMesh mesh;
+		// vertices in front of these never change again
+		size_t stableVertices = 0;
+		// the ring the tube's stable part ends with, the tail is built on from it
+		Ring lastStableRing;
+		bool bHasStableRing = false;
+		Ring previousRing;
+		Ring ring;
+		bool bHasPreviousRing = false;
+
+		ofVbo vbo;
+		ofBufferObject vertexBuffer;
+		ofBufferObject normalBuffer;
+		ofBufferObject texCoordBuffer;
+		size_t bufferCapacity = 0;
+		// first vertex that changed since the last upload
+		size_t dirtyStart = 0;
+
+		size_t rewrittenVertices = 0;
+		size_t bufferAllocationCount = 0;
+};
@@ -7,241 +7,262 @@
 
 #include "ofxBezierTubeMeshBuilder.h"
 #include "ofxBezierUtility.h"
+#include "ofxBezierCapTemplates.h"
 
-ofxBezierTubeMeshBuilder::ofxBezierTubeMeshBuilder(ofxBezierEditorSettings & settings) : settings(settings){
+ofxBezierTubeMeshBuilder::ofxBezierTubeMeshBuilder(ofxBezierMeshSettings & settings) : settings(settings){
 	// Initialization
 }
 
 ofxBezierTubeMeshBuilder::~ofxBezierTubeMeshBuilder(){
 	// Cleanup
 }
-ofVboMesh ofxBezierTubeMeshBuilder::getTubeMeshFromPolyline(ofPolyline inPoly){
+ofVboMesh ofxBezierTubeMeshBuilder::getTubeMeshFromPolyline(const ofPolyline & inPoly){
 	generateTubeMeshFromPolyline(inPoly);
 	return tubeMesh;
 }
 
-void ofxBezierTubeMeshBuilder::generateTubeMeshFromPolyline(ofPolyline inPoly){
-	if(inPoly.size() > 1){
+void ofxBezierTubeMeshBuilder::moveTubeMeshInto(ofMesh & target){
+	target.clear();
+	target.setMode(tubeMesh.getMode());
+	std::swap(target.getVertices(), tubeMesh.getVertices());
+	std::swap(target.getNormals(), tubeMesh.getNormals());
+	std::swap(target.getTexCoords(), tubeMesh.getTexCoords());
+}
 
-		tubeMesh.clear();
-		tubeMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
-		ofPolyline workerLine;
+void ofxBezierTubeMeshBuilder::BuildTubeMesh(const ofxBezierPointSpan & points, const ofxBezierMeshSettings & settings, ofMesh & output){
+	ofxBezierMeshSettings buildSettings = settings;
+	ofxBezierTubeMeshBuilder builder(buildSettings);
+	ofPolyline line;
+	line.addVertices(points.data, points.size);
+	// the builders expect a closed line to end on its first point, as the editor's polylines do
+	if(settings.bIsClosed && points.size > 1 && points.data[points.size - 1] != points.data[0]){
+		line.addVertex(points.data[0]);
+	}
+	line.setClosed(settings.bIsClosed);
+
+	// build straight into the caller's buffers
+	std::swap(builder.tubeMesh.getVertices(), output.getVertices());
+	std::swap(builder.tubeMesh.getNormals(), output.getNormals());
+	std::swap(builder.tubeMesh.getTexCoords(), output.getTexCoords());
+	builder.generateTubeMeshFromPolyline(line);
+	builder.moveTubeMeshInto(output);
+}
 
-		//We use these to store the information from our line
-		points.clear();
-		tangents.clear();
-		normals.clear();
+void ofxBezierTubeMeshBuilder::generateTubeMeshFromPolyline(const ofPolyline & inPoly){
+	simplifyReductionRatio = 1.0;
+	const ofPolyline * line = &inPoly;
+	ofPolyline simplified;
+	if(settings.simplifyTolerance > 0 && inPoly.size() > 2){
+		simplifyReductionRatio = ofxBezierUtility::SimplifyPolyline(inPoly, simplified, settings.simplifyTolerance, settings.simplifyMaxAngle);
+		line = &simplified;
+	}
+	if(line->size() > 1){
+		clearSamples();
+		if(settings.bArcLengthSampling){
+			ofxBezierUtility::CalculateArcLengthTangentsNormalsAndPoints(*line, points, tangents, normals, settings.sampleSpacing, settings.curvatureWeight);
+		}else{
+			ofxBezierUtility::CalculateInterpolatedTangentsNormalsAndPoints(*line, points, tangents, normals, settings.meshLengthPrecisionMultiplier);
+		}
+		generateTubeMeshFromSamples();
+	}
+}
 
-		allCircleVertices.clear();
-		allCircleNormals.clear();
-		allCircleTexCoords.clear();
+void ofxBezierTubeMeshBuilder::generateTubeMeshFromSegments(const std::vector <ofxBezierSegmentTree::Segment> & segments){
+	simplifyReductionRatio = 1.0;
+	if(!segments.empty()){
+		clearSamples();
+		ofxBezierUtility::CalculateSegmentTangentsNormalsAndPoints(segments, settings, points, tangents, normals);
+		if(points.size() > 1){
+			generateTubeMeshFromSamples();
+		}
+	}
+}
 
-		segmentDistances.clear();
-		totalLineLength = 0;
+void ofxBezierTubeMeshBuilder::clearSamples(){
+	// remember the buffer sizes so we can tell how many of them had to grow
+	capacities = {
+		tubeMesh.getVertices().capacity(), tubeMesh.getNormals().capacity(), tubeMesh.getTexCoords().capacity(),
+		points.capacity(), tangents.capacity(), normals.capacity(), allCircleVertices.capacity(), segmentDistances.capacity()
+	};
+
+	//We use these to store the information from our line
+	points.clear();
+	tangents.clear();
+	normals.clear();
+}
 
-		ofxBezierUtility::ReflectEndPoints(inPoly, workerLine);
-		ofxBezierUtility::CalculateInterpolatedTangentsNormalsAndPoints(workerLine, points, tangents, normals, settings.meshLengthPrecisionMultiplier);
-		ofxBezierUtility::CalculateLineLengths(points, segmentDistances, totalLineLength, settings.roundCap, settings.tubeRadius * 2);
+void ofxBezierTubeMeshBuilder::generateTubeMeshFromSamples(){
+	tubeMesh.clear();
+	tubeMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
 
-		//We add the top cap first
-		if(settings.roundCap && !settings.bIsClosed){
-			generateCurvedTubeCap(points[0], tangents[0], normals[0], true, totalLineLength);
-		}
-		if(!settings.roundCap && !settings.bIsClosed){
-			generateFlatTubeCap(points[0], tangents[0], normals[0], true, totalLineLength);
-		}
+	allCircleVertices.clear();
+	allCircleNormals.clear();
+	allCircleTexCoords.clear();
 
+	segmentDistances.clear();
+	totalLineLength = 0;
 
-		// Generate vertices for the circles
-		for(int i = 0; i < points.size(); i++){
-			const ofVec3f & p0 = points[i];
-			const ofVec3f & n0 = normals[i];
-			const ofVec3f & t0 = tangents[i];
+	ofxBezierUtility::CalculateLineLengths(points, segmentDistances, totalLineLength, settings.roundCap, settings.tubeRadius * 2);
+	capTemplate = &ofxBezierCapTemplates::GetTubeCap(settings.tubeResolution);
 
-			vector <ofVec3f> circleVertices;
-			vector <ofVec3f> circleNormals;
-			vector <ofVec2f> circleTexCoords;
+	//We add the top cap first
+	if(settings.roundCap && !settings.bIsClosed){
+		generateCurvedTubeCap(points[0], tangents[0], normals[0], true, totalLineLength);
+	}
+	if(!settings.roundCap && !settings.bIsClosed){
+		generateFlatTubeCap(points[0], tangents[0], normals[0], true, totalLineLength);
+	}
 
-			//we will make aring around all the points we collected
-			for(int j = 0; j <= settings.tubeResolution; j++){   // Use <= to include the last point in the circle
-				float p = j / static_cast <float>(settings.tubeResolution);
-				float a = p * 360;
-				ofVec3f v0 = n0.getRotated(a, t0) * settings.tubeRadius + p0;
-				circleVertices.push_back(v0);
 
-				ofVec3f normal = v0 - p0;
-				normal.normalize();
-				circleNormals.push_back(normal);
+	// Generate vertices for the circles
+	for(int i = 0; i < points.size(); i++){
+		const ofVec3f & p0 = points[i];
+		const ofVec3f & n0 = normals[i];
+		const ofVec3f & t0 = tangents[i];
+		ofVec3f b0 = t0.getCrossed(n0);
 
-				ofVec2f texCoord(a / 360.0, segmentDistances[i] / totalLineLength);
-				circleTexCoords.push_back(texCoord);
+		vector <ofVec3f> circleVertices;
+		vector <ofVec3f> circleNormals;
+		vector <ofVec2f> circleTexCoords;
 
-			}
+		//we will make aring around all the points we collected, the angles come from the cap template
+		for(int j = 0; j <= settings.tubeResolution; j++){   // Use <= to include the last point in the circle
+			float p = j / static_cast <float>(settings.tubeResolution);
+			// the normal turned around the tangent, as getRotated would do it
+			ofVec3f normal = n0 * capTemplate->ringCos[j] + b0 * capTemplate->ringSin[j];
+			circleVertices.push_back(normal * settings.tubeRadius + p0);
+			circleNormals.push_back(normal);
 
-			allCircleVertices.push_back(circleVertices);
-			allCircleNormals.push_back(circleNormals);
-			allCircleTexCoords.push_back(circleTexCoords);
+			ofVec2f texCoord(p, segmentDistances[i] / totalLineLength);
+			circleTexCoords.push_back(texCoord);
 
 		}
 
-		if(settings.roundCap && !settings.bIsClosed){
-			generateCurvedTubeCap(points[points.size() - 1], tangents[tangents.size() - 1], normals[normals.size() - 1], false, totalLineLength);
-		}
+		allCircleVertices.push_back(circleVertices);
+		allCircleNormals.push_back(circleNormals);
+		allCircleTexCoords.push_back(circleTexCoords);
 
-		if(!settings.roundCap && !settings.bIsClosed){
-			generateFlatTubeCap(points[points.size() - 1], tangents[tangents.size() - 1], normals[normals.size() - 1], false, totalLineLength);
-		}
-        
-        int wrapExtent;
-        if(!settings.bIsClosed){
-            wrapExtent = allCircleVertices.size() - 1;
-        }
-        else{
-            wrapExtent = allCircleVertices.size() - 2;
-        }
-        
-		//go through the circles and build the mesh
-		for(int i = 0; i < wrapExtent; i++){
-			const vector <ofVec3f> & circle1 = allCircleVertices[i];
-			const vector <ofVec3f> & circle2 = allCircleVertices[i + 1];
-			const vector <ofVec3f> & normals1 = allCircleNormals[i];
-			const vector <ofVec3f> & normals2 = allCircleNormals[i + 1];
+	}
 
-			const vector <ofVec2f> & texCoords1 = allCircleTexCoords[i];
-			const vector <ofVec2f> & texCoords2 = allCircleTexCoords[i + 1];
+	if(settings.roundCap && !settings.bIsClosed){
+		generateCurvedTubeCap(points[points.size() - 1], tangents[tangents.size() - 1], normals[normals.size() - 1], false, totalLineLength);
+	}
+
+	if(!settings.roundCap && !settings.bIsClosed){
+		generateFlatTubeCap(points[points.size() - 1], tangents[tangents.size() - 1], normals[normals.size() - 1], false, totalLineLength);
+	}
+    
+    int wrapExtent;
+    if(!settings.bIsClosed){
+        wrapExtent = allCircleVertices.size() - 1;
+    }
+    else{
+        wrapExtent = allCircleVertices.size() - 2;
+    }
+    
+	//go through the circles and build the mesh
+	for(int i = 0; i < wrapExtent; i++){
+		const vector <ofVec3f> & circle1 = allCircleVertices[i];
+		const vector <ofVec3f> & circle2 = allCircleVertices[i + 1];
+		const vector <ofVec3f> & normals1 = allCircleNormals[i];
+		const vector <ofVec3f> & normals2 = allCircleNormals[i + 1];
+
+		const vector <ofVec2f> & texCoords1 = allCircleTexCoords[i];
+		const vector <ofVec2f> & texCoords2 = allCircleTexCoords[i + 1];
 
 
-            
-			for(int j = 0; j < circle1.size(); j++){
+        
+		for(int j = 0; j < circle1.size(); j++){
 
-				// Add two vertices at a time: one from the current circle, one from the next
-				tubeMesh.addVertex(circle1[j]);
-				tubeMesh.addVertex(circle2[j]);
+			// Add two vertices at a time: one from the current circle, one from the next
+			tubeMesh.addVertex(circle1[j]);
+			tubeMesh.addVertex(circle2[j]);
+			if(settings.bMeshNormals){
 				tubeMesh.addNormal(normals1[j]);
 				tubeMesh.addNormal(normals2[j]);
+			}
+			if(settings.bMeshTexCoords){
 				tubeMesh.addTexCoord(texCoords1[j]);
 				tubeMesh.addTexCoord(texCoords2[j]);
 			}
 		}
-        if(settings.bIsClosed){
-            for(int j = 0; j < allCircleVertices[0].size(); j++){
-                tubeMesh.addVertex(allCircleVertices[allCircleVertices.size()-2][j]);
-                tubeMesh.addVertex(allCircleVertices[0][j]);
+	}
+    if(settings.bIsClosed){
+        for(int j = 0; j < allCircleVertices[0].size(); j++){
+            tubeMesh.addVertex(allCircleVertices[allCircleVertices.size()-2][j]);
+            tubeMesh.addVertex(allCircleVertices[0][j]);
+            if(settings.bMeshNormals){
                 tubeMesh.addNormal(allCircleNormals[allCircleNormals.size()-2][j]);
                 tubeMesh.addNormal(allCircleNormals[0][j]);
+            }
+            if(settings.bMeshTexCoords){
                 tubeMesh.addTexCoord(allCircleTexCoords[allCircleTexCoords.size()-2][j]);
                 tubeMesh.addTexCoord(allCircleTexCoords[0][j]);
             }
         }
+    }
+
+	std::array <size_t, 8> newCapacities = {
+		tubeMesh.getVertices().capacity(), tubeMesh.getNormals().capacity(), tubeMesh.getTexCoords().capacity(),
+		points.capacity(), tangents.capacity(), normals.capacity(), allCircleVertices.capacity(), segmentDistances.capacity()
+	};
+	bufferGrowths = 0;
+	for(int i = 0; i < newCapacities.size(); i++){
+		if(newCapacities[i] != capacities[i]){
+			bufferGrowths++;
+		}
 	}
 }
 
 void ofxBezierTubeMeshBuilder::generateCurvedTubeCap(const ofVec3f & centre, const ofVec3f & tangent, const ofVec3f & normal, bool forwards, float _totalLineLength){
-	float step = settings.tubeRadius / (settings.tubeResolution + 1);
-	ofVec3f poleCenter;
+	// the rings of a unit hemisphere, from the equator (0) to the pole (resolution + 1)
+	const vector <float> & offsets = capTemplate->hemisphereOffsets;
+	const vector <float> & radii = capTemplate->hemisphereRadii;
+	int pole = offsets.size() - 1;
+	float radius = settings.tubeRadius;
 	if(forwards){
-		poleCenter = centre - tangent * settings.tubeRadius;
-
-		addRing(poleCenter, 0, tangent, normal, centre, 0, _totalLineLength);
-		// Loop to generate each ring, starting from the one closest to the equator and moving towards the pole
-		for(int i = settings.tubeResolution; i >= 1; i--){
-			// Calculate the vertical distance from the center to the current ring
-			float verticalDistance = step * i;
-			// Calculate the actual distance from the sphere center to the ring center on the surface of the hemisphere
-			float ringDistance = settings.tubeRadius * cos(asin(verticalDistance / settings.tubeRadius));
-			// Calculate the ring center point
-			ofVec3f ringCenter = centre - tangent * verticalDistance;
-
-			// Calculate the ring radius
-			float ringRadius = sqrt(settings.tubeRadius * settings.tubeRadius - verticalDistance * verticalDistance);
-
-			// Add the calculated ring to the vectors
-			addRing(ringCenter, ringRadius, tangent, normal, centre, settings.tubeRadius - verticalDistance, _totalLineLength);
+		// starting from the pole and moving towards the equator
+		for(int i = pole; i >= 1; i--){
+			float verticalDistance = offsets[i] * radius;
+			addRing(centre - tangent * verticalDistance, radii[i] * radius, tangent, normal, centre, radius - verticalDistance, _totalLineLength);
 		}
-	}
-
-
-
-	if(!forwards){
-
-		for(int i = 1; i <= settings.tubeResolution; i++){
-			// Calculate the vertical distance from the center to the current ring
-			float verticalDistance = step * i;
-			// Calculate the actual distance from the sphere center to the ring center on the surface of the hemisphere
-			float ringDistance = settings.tubeRadius * cos(asin(verticalDistance / settings.tubeRadius));
-			// Calculate the ring center point
-			ofVec3f ringCenter = centre + tangent * verticalDistance;
-
-			// Calculate the ring radius
-			float ringRadius = sqrt(settings.tubeRadius * settings.tubeRadius - verticalDistance * verticalDistance);
-
-			// Add the calculated ring to the vectors
-			addRing(ringCenter, ringRadius, tangent, normal, centre,  (_totalLineLength - settings.tubeRadius) + verticalDistance, _totalLineLength);
+	}else{
+		for(int i = 1; i <= pole; i++){
+			float verticalDistance = offsets[i] * radius;
+			addRing(centre + tangent * verticalDistance, radii[i] * radius, tangent, normal, centre, (_totalLineLength - radius) + verticalDistance, _totalLineLength);
 		}
-		ofVec3f southPoleCenter = centre + tangent * settings.tubeRadius;
-		addRing(southPoleCenter, 0, tangent, normal, centre, _totalLineLength, _totalLineLength);
 	}
-
 }
 
 void ofxBezierTubeMeshBuilder::generateFlatTubeCap(const ofVec3f & flatCapCentre, const ofVec3f & tangent, const ofVec3f & normal, bool forwards, float _totalLineLength){
-
-	if(forwards){
-		for(int i = 0; i < settings.tubeResolution; i++){
-
-			vector <ofVec3f> circleVertices;
-			vector <ofVec3f> circleNormals;
-			vector <ofVec2f> circleTexCoords;
-
-			float ringRadius = (settings.tubeRadius / settings.tubeResolution) * i;
-
-			for(int j = 0; j <= settings.tubeResolution; j++){   // Use <= to include the last point in the circle
-				float p = j / static_cast <float>(settings.tubeResolution);
-				float a = p * 360;
-				ofVec3f v0 = normal.getRotated(a, tangent) * ringRadius + flatCapCentre;
-				circleVertices.push_back(v0);
-
-				ofVec3f normal = tangent * -1;
-				normal.normalize();
-				circleNormals.push_back(normal);
-
-				ofVec2f texCoord(a / 360.0, ringRadius / _totalLineLength);
-				circleTexCoords.push_back(texCoord);
-			}
-
-			allCircleVertices.push_back(circleVertices);
-			allCircleNormals.push_back(circleNormals);
-			allCircleTexCoords.push_back(circleTexCoords);
+	ofVec3f binormal = tangent.getCrossed(normal);
+	// the discs face away from the line
+	ofVec3f discNormal = forwards ? tangent * -1 : tangent;
+	discNormal.normalize();
+
+	for(int k = 0; k < settings.tubeResolution; k++){
+		// shrinking towards the centre at the start, growing from it at the end
+		int i = forwards ? k : settings.tubeResolution - 1 - k;
+
+		vector <ofVec3f> circleVertices;
+		vector <ofVec3f> circleNormals;
+		vector <ofVec2f> circleTexCoords;
+
+		float ringRadius = (settings.tubeRadius / settings.tubeResolution) * i;
+		float v = forwards ? ringRadius / _totalLineLength : (ringRadius + (_totalLineLength - settings.tubeRadius)) / _totalLineLength;
+
+		for(int j = 0; j <= settings.tubeResolution; j++){   // Use <= to include the last point in the circle
+			float p = j / static_cast <float>(settings.tubeResolution);
+			ofVec3f v0 = (normal * capTemplate->ringCos[j] + binormal * capTemplate->ringSin[j]) * ringRadius + flatCapCentre;
+			circleVertices.push_back(v0);
+			circleNormals.push_back(discNormal);
+			circleTexCoords.push_back(ofVec2f(p, v));
 		}
-	}else{
-		for(int i = settings.tubeResolution - 1; i >= 0; i--){
-
-			vector <ofVec3f> circleVertices;
-			vector <ofVec3f> circleNormals;
-			vector <ofVec2f> circleTexCoords;
-
-			float ringRadius = (settings.tubeRadius / settings.tubeResolution) * i;
 
-			for(int j = 0; j <= settings.tubeResolution; j++){   // Use <= to include the last point in the circle
-				float p = j / static_cast <float>(settings.tubeResolution);
-				float a = p * 360;
-				ofVec3f v0 = normal.getRotated(a, tangent) * ringRadius + flatCapCentre;
-				circleVertices.push_back(v0);
-
-				ofVec3f normal = tangent;
-				normal.normalize();
-				circleNormals.push_back(normal);
-
-				ofVec2f texCoord(a / 360.0, (ringRadius + (_totalLineLength - settings.tubeRadius)) / _totalLineLength);
-				circleTexCoords.push_back(texCoord);
-			}
-
-			allCircleVertices.push_back(circleVertices);
-			allCircleNormals.push_back(circleNormals);
-			allCircleTexCoords.push_back(circleTexCoords);
-		}
+		allCircleVertices.push_back(circleVertices);
+		allCircleNormals.push_back(circleNormals);
+		allCircleTexCoords.push_back(circleTexCoords);
 	}
-
 }
 
 
@@ -250,10 +271,10 @@ void ofxBezierTubeMeshBuilder::addRing(const ofVec3f & ringCenter, float radius,
 	std::vector <ofVec3f> circleNormals;
 	std::vector <ofVec2f> circleTexCoords;
 
+	ofVec3f binormal = tangent.getCrossed(normal);
 	for(int j = 0; j <= settings.tubeResolution; j++){   // Use <= to include the last point in the circle
 		float p = j / static_cast <float>(settings.tubeResolution);
-		float a = p * 360;
-		ofVec3f v0 = normal.getRotated(a, tangent) * radius + ringCenter;
+		ofVec3f v0 = (normal * capTemplate->ringCos[j] + binormal * capTemplate->ringSin[j]) * radius + ringCenter;
 		circleVertices.push_back(v0);
 
 		ofVec3f normalAtVertex = (v0 - sphereCenter).getNormalized();
@@ -266,4 +287,3 @@ void ofxBezierTubeMeshBuilder::addRing(const ofVec3f & ringCenter, float radius,
 	allCircleNormals.push_back(circleNormals);
 	allCircleTexCoords.push_back(circleTexCoords);
 }
-
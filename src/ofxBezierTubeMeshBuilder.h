@@ -8,24 +8,50 @@
 
 #pragma once
 #include "ofMain.h"
-#include "ofxBezierEditorSettings.h"
+#include "ofxBezierMeshSettings.h"
 #include "ofxBezierEvents.h"
+#include "ofxBezierSegmentTree.h"
+#include "ofxBezierCapTemplates.h"
 
 class ofxBezierTubeMeshBuilder {
 	public:
-		ofxBezierTubeMeshBuilder(ofxBezierEditorSettings & settings);
+		ofxBezierTubeMeshBuilder(ofxBezierMeshSettings & settings);
 
 		~ofxBezierTubeMeshBuilder();
 
 		ofVboMesh getTubeMesh(){
 			return tubeMesh;
 		}
-		ofVboMesh getTubeMeshFromPolyline(ofPolyline inPoly);
-		void generateTubeMeshFromPolyline(ofPolyline inPoly);
+		ofVboMesh getTubeMeshFromPolyline(const ofPolyline & inPoly);
+		void generateTubeMeshFromPolyline(const ofPolyline & inPoly);
+		// Samples the cubic segments directly, with exact tangents and normals from their derivative.
+		// The simplify tolerance does not apply, there is no polyline to simplify.
+		void generateTubeMeshFromSegments(const std::vector <ofxBezierSegmentTree::Segment> & segments);
 
+		// Hands the last generated mesh over to target without copying it
+		void moveTubeMeshInto(ofMesh & target);
+
+		// Meshes points with settings into output and touches nothing else, see ofxBezierRibbonMeshBuilder::BuildRibbonMesh
+		static void BuildTubeMesh(const ofxBezierPointSpan & points, const ofxBezierMeshSettings & settings, ofMesh & output);
+
+		// Stats of the last build, used by the profiler
+		size_t getRingCount(){
+			return allCircleVertices.size();
+		}
+		// how many of the builder's reused buffers (mesh arrays and samples) had to grow. Not a count of heap
+		// allocations: a buffer can reallocate more than once while it grows, and the vectors made for every ring aren't included
+		size_t getBufferGrowths(){
+			return bufferGrowths;
+		}
+		float getSimplifyReductionRatio(){
+			return simplifyReductionRatio;
+		}
 
-	private:
 
+	private:
+		void clearSamples();
+		// builds the mesh from points, tangents and normals
+		void generateTubeMeshFromSamples();
 
 		void createLatitudeRings(const ofVec3f & center, const ofVec3f & extension, float tubeResolution, float tubeRadius, bool forwards);
 
@@ -37,7 +63,7 @@ class ofxBezierTubeMeshBuilder {
 
 		ofVboMesh tubeMesh;
 
-		ofxBezierEditorSettings & settings;
+		ofxBezierMeshSettings & settings;
 
 		void onTriggerUpdate(TriggerUpdateEventArgs & args);
 
@@ -54,6 +80,12 @@ class ofxBezierTubeMeshBuilder {
 
 		std::vector <float> segmentDistances;
 		float totalLineLength = 0;
+		// shared unit rings for the current resolution, used for the caps and around the line
+		const ofxBezierCapTemplates::TubeCap * capTemplate = nullptr;
+
+		size_t bufferGrowths = 0;
+		std::array <size_t, 8> capacities;
+		float simplifyReductionRatio = 1.0;
 
 
 };
@@ -6,26 +6,32 @@
 //
 
 #include "ofxBezierUI.h"
+#include "ofxBezierUtility.h"
 
 ofxBezierUI::ofxBezierUI(ofxBezierEditorSettings & settings,
+						 const ofxBezierSegmentTree & segmentTree,
+						 ofxBezierHistory & history,
 						 std::vector <draggableVertex> & curveVertices,
 						 std::vector <draggableVertex> & controlPoint1,
 						 std::vector <draggableVertex> & controlPoint2)
-	: settings(settings), curveVertices(curveVertices), controlPoint1(controlPoint1), controlPoint2(controlPoint2){
+	: settings(settings), segmentTree(segmentTree), history(history), curveVertices(curveVertices), controlPoint1(controlPoint1), controlPoint2(controlPoint2){
 
 	setReactToMouseAndKeyEvents(true);
+	ofAddListener(ofEvents().update, this, &ofxBezierUI::onUpdate);
 
 }
 
 ofxBezierUI::~ofxBezierUI(){
 	setReactToMouseAndKeyEvents(false);
+	ofRemoveListener(ofEvents().update, this, &ofxBezierUI::onUpdate);
 }
 
 void ofxBezierUI::mouseMoved(ofMouseEventArgs & args){
 	if(settings.beditBezier == true){
+		glm::vec2 mouse = settings.toCurveCoordinates(glm::vec2(args.x, args.y));
 		for(int i = 0; i < curveVertices.size(); i++){
-			float diffx = args.x - curveVertices.at(i).pos.x;
-			float diffy = args.y - curveVertices.at(i).pos.y;
+			float diffx = mouse.x - curveVertices.at(i).pos.x;
+			float diffy = mouse.y - curveVertices.at(i).pos.y;
 			float dist = sqrt(diffx * diffx + diffy * diffy);
 			if(dist < settings.radiusVertex){
 				curveVertices.at(i).bOver = true;
@@ -35,8 +41,8 @@ void ofxBezierUI::mouseMoved(ofMouseEventArgs & args){
 		}
 
 		for(int i = 0; i < controlPoint1.size(); i++){
-			float diffx = args.x - controlPoint1.at(i).pos.x;
-			float diffy = args.y - controlPoint1.at(i).pos.y;
+			float diffx = mouse.x - controlPoint1.at(i).pos.x;
+			float diffy = mouse.y - controlPoint1.at(i).pos.y;
 			float dist = sqrt(diffx * diffx + diffy * diffy);
 			if(dist < settings.radiusControlPoints){
 				controlPoint1.at(i).bOver = true;
@@ -46,8 +52,8 @@ void ofxBezierUI::mouseMoved(ofMouseEventArgs & args){
 		}
 
 		for(int i = 0; i < controlPoint2.size(); i++){
-			float diffx = args.x - controlPoint2.at(i).pos.x;
-			float diffy = args.y - controlPoint2.at(i).pos.y;
+			float diffx = mouse.x - controlPoint2.at(i).pos.x;
+			float diffy = mouse.y - controlPoint2.at(i).pos.y;
 			float dist = sqrt(diffx * diffx + diffy * diffy);
 			if(dist < settings.radiusControlPoints){
 				controlPoint2.at(i).bOver = true;
@@ -62,51 +68,62 @@ void ofxBezierUI::mouseMoved(ofMouseEventArgs & args){
 void ofxBezierUI::mouseDragged(ofMouseEventArgs & args){
 	if(settings.beditBezier){
 		if(settings.bshowBoundingBox){
-			int deltaX = args.x - mouseX;
-			int deltaY = args.y - mouseY;
+			// only the transform moves while dragging, it is baked into the points once when the mouse is released
+			settings.transformTranslation += glm::vec2(args.x - mouseX, args.y - mouseY);
+			mouseX = args.x;
+			mouseY = args.y;
+			bTransformDragged = true;
+			return;
+		}
 
-			for(int i = 0; i < curveVertices.size(); i++){
-				curveVertices.at(i).pos.x += deltaX;
-				curveVertices.at(i).pos.y += deltaY;
-			}
+		// mice and tablets can send several events per frame, only the last position is used.
+		// The points move and the geometry is rebuilt once per frame in applyPendingDrag
+		dragPosition = settings.toCurveCoordinates(glm::vec2(args.x, args.y));
+		pendingDragEvents++;
+	}
 
-			for(int i = 0; i < controlPoint1.size(); i++){
-				controlPoint1.at(i).pos.x += deltaX;
-				controlPoint1.at(i).pos.y += deltaY;
-			}
+}
 
-			for(int i = 0; i < controlPoint2.size(); i++){
-				controlPoint2.at(i).pos.x += deltaX;
-				controlPoint2.at(i).pos.y += deltaY;
-			}
+//--------------------------------------------------------------
+void ofxBezierUI::onUpdate(ofEventArgs & args){
+	applyPendingDrag();
+}
 
-			mouseX = args.x;
-			mouseY = args.y;
+void ofxBezierUI::applyPendingDrag(){
+	if(pendingDragEvents == 0){
+		return;
+	}
+	bool bAnyMoved = false;
+	for(int i = 0; i < curveVertices.size(); i++){
+		if(curveVertices.at(i).bBeingDragged == true){
+			curveVertices.at(i).pos = dragPosition;
+			bAnyMoved = true;
 		}
+	}
 
-		for(int i = 0; i < curveVertices.size(); i++){
-			if(curveVertices.at(i).bBeingDragged == true){
-				curveVertices.at(i).pos.x = args.x;
-				curveVertices.at(i).pos.y = args.y;
-			}
+	for(int i = 0; i < controlPoint1.size(); i++){
+		if(controlPoint1.at(i).bBeingDragged == true){
+			controlPoint1.at(i).pos = dragPosition;
+			bAnyMoved = true;
 		}
+	}
 
-		for(int i = 0; i < controlPoint1.size(); i++){
-			if(controlPoint1.at(i).bBeingDragged == true){
-				controlPoint1.at(i).pos.x = args.x;
-				controlPoint1.at(i).pos.y = args.y;
-			}
+	for(int i = 0; i < controlPoint2.size(); i++){
+		if(controlPoint2.at(i).bBeingDragged == true){
+			controlPoint2.at(i).pos = dragPosition;
+			bAnyMoved = true;
 		}
-
-		for(int i = 0; i < controlPoint2.size(); i++){
-			if(controlPoint2.at(i).bBeingDragged == true){
-				controlPoint2.at(i).pos.x = args.x;
-				controlPoint2.at(i).pos.y = args.y;
-			}
-		}
-		triggerUpdate();
 	}
 
+	dragEventCount += pendingDragEvents;
+	mergedDragEventCount += pendingDragEvents - 1;
+	int merged = pendingDragEvents - 1;
+	pendingDragEvents = 0;
+	if(bAnyMoved){
+		// the whole drag is one undo step, the editor seals it once the mouse is released
+		recordHistory("mouseDragged", true);
+		triggerUpdate("mouseDragged", merged);
+	}
 }
 
 //--------------------------------------------------------------
@@ -116,12 +133,14 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 			if(settings.bshowBoundingBox){
 				mouseX = args.x;
 				mouseY = args.y;
+				settings.bInteracting = true;
 			}else{
+				glm::vec2 mouse = settings.toCurveCoordinates(glm::vec2(args.x, args.y));
 				bool bAnyVertexDragged = false;
 				// MOVE vertex
 				for(int i = 0; i < curveVertices.size(); i++){
-					float diffx = args.x  - curveVertices.at(i).pos.x;
-					float diffy = args.y  - curveVertices.at(i).pos.y;
+					float diffx = mouse.x  - curveVertices.at(i).pos.x;
+					float diffy = mouse.y  - curveVertices.at(i).pos.y;
 					float dist = sqrt(diffx * diffx + diffy * diffy);
 					if(dist < settings.radiusVertex){
 						curveVertices.at(i).bBeingDragged = true;
@@ -132,8 +151,8 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 				}
 
 				for(int i = 0; i < controlPoint1.size(); i++){
-					float diffx = args.x  - controlPoint1.at(i).pos.x;
-					float diffy = args.y  - controlPoint1.at(i).pos.y;
+					float diffx = mouse.x  - controlPoint1.at(i).pos.x;
+					float diffy = mouse.y  - controlPoint1.at(i).pos.y;
 					float dist = sqrt(diffx * diffx + diffy * diffy);
 					if(dist < settings.radiusControlPoints){
 						controlPoint1.at(i).bBeingDragged = true;
@@ -144,8 +163,8 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 				}
 
 				for(int i = 0; i < controlPoint2.size(); i++){
-					float diffx = args.x  - controlPoint2.at(i).pos.x;
-					float diffy = args.y  - controlPoint2.at(i).pos.y;
+					float diffx = mouse.x  - controlPoint2.at(i).pos.x;
+					float diffy = mouse.y  - controlPoint2.at(i).pos.y;
 					float dist = sqrt(diffx * diffx + diffy * diffy);
 					if(dist < settings.radiusControlPoints){
 						controlPoint2.at(i).bBeingDragged = true;
@@ -155,11 +174,13 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 					}
 				}
 
+				settings.bInteracting = bAnyVertexDragged;
+
 				// ADD vertex to the end
 				if(bAnyVertexDragged == false){
 					draggableVertex vtx;
-					vtx.pos.x = args.x;
-					vtx.pos.y = args.y;
+					vtx.pos.x = mouse.x;
+					vtx.pos.y = mouse.y;
 					vtx.bOver = true;
 					vtx.bBeingDragged = false;
 					vtx.bBeingSelected = false;
@@ -177,17 +198,19 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 					cp.pos.y = ofLerp(curveVertices.at(0).pos.y, curveVertices.at(nEnd).pos.y, 0.33);
 					controlPoint2.push_back(cp);
 
-					triggerUpdate();
+					recordHistory("mousePressed");
+					triggerUpdate("mousePressed");
 
 				}
 			}
 		}
 		if(args.button == OF_MOUSE_BUTTON_RIGHT){
+			glm::vec2 mouse = settings.toCurveCoordinates(glm::vec2(args.x, args.y));
 			// SELECT several vertex
 			bool bAnyVertexSelected = false;
 			for(int i = 0; i < curveVertices.size(); i++){
-				float diffx = args.x  - curveVertices.at(i).pos.x;
-				float diffy = args.y  - curveVertices.at(i).pos.y;
+				float diffx = mouse.x  - curveVertices.at(i).pos.x;
+				float diffy = mouse.y  - curveVertices.at(i).pos.y;
 				float dist = sqrt(diffx * diffx + diffy * diffy);
 				if(dist < settings.radiusVertex){
 					curveVertices.at(i).bBeingSelected = !curveVertices.at(i).bBeingSelected;
@@ -195,6 +218,16 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 				}
 			}
 
+			// ADD vertex on the curve where it was clicked
+			if(bAnyVertexSelected == false){
+				ofxBezierSegmentTree::ClosestPoint hit = segmentTree.closestPoint(mouse, settings.radiusVertex);
+				if(hit.segment >= 0){
+					insertVertexOnSegment(hit.segment, hit.t);
+					triggerUpdate("mousePressed");
+					return;
+				}
+			}
+
 			if(bAnyVertexSelected == false){
 				int numVertexSelected = 0;
 				lastVertexSelected = 0;
@@ -207,8 +240,8 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 				// ADD vertex between two points
 				if(numVertexSelected >= 2){
 					draggableVertex vtx;
-					vtx.pos.x = args.x;
-					vtx.pos.y = args.y;
+					vtx.pos.x = mouse.x;
+					vtx.pos.y = mouse.y;
 					vtx.bOver = true;
 					vtx.bBeingDragged = false;
 					vtx.bBeingSelected = false;
@@ -225,7 +258,8 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 					cp.pos.y = ofLerp(curveVertices.at(lastVertexSelected - 1).pos.y, curveVertices.at(lastVertexSelected).pos.y, 0.33);
 					controlPoint2.insert(controlPoint2.begin() + lastVertexSelected, cp);
 
-					triggerUpdate();
+					recordHistory("mousePressed");
+					triggerUpdate("mousePressed");
 				}
 			}
 		}
@@ -234,6 +268,16 @@ void ofxBezierUI::mousePressed(ofMouseEventArgs & args){
 
 //--------------------------------------------------------------
 void ofxBezierUI::mouseReleased(ofMouseEventArgs & args){
+	// the last position of the drag must not wait for the next frame
+	applyPendingDrag();
+	settings.bInteracting = false;
+	if(bTransformDragged){
+		// one rebuild per drag, so the polyline, bounds and meshes follow the shape again
+		bTransformDragged = false;
+		settings.bakeTransform();
+		recordHistory("bakeTransform");
+		triggerUpdate("bakeTransform");
+	}
 	if(settings.beditBezier){
 		for(int i = 0; i < curveVertices.size(); i++){
 			curveVertices.at(i).bBeingDragged = false;
@@ -267,16 +311,28 @@ void ofxBezierUI::keyPressed(ofKeyEventArgs & args){
 			settings.savePoints(settings.jsonFileName);
 		}else if(args.key == 'l'){
 			settings.loadPoints(settings.jsonFileName);
-			triggerUpdate();
+			recordHistory("loadPoints");
+			triggerUpdate("keyPressed");
 		}else if(args.key == 'f'){
 			settings.bfillBezier = !settings.bfillBezier;
-			triggerUpdate();
+			triggerUpdate("keyPressed");
 		}else if(args.key == 'b'){
 			settings.bshowBoundingBox = !settings.bshowBoundingBox;
-			triggerUpdate();
+			triggerUpdate("keyPressed");
 		}else if(args.key == 'c'){
 			settings.bIsClosed = !settings.bIsClosed;
-			triggerUpdate();
+			recordHistory("keyPressed");
+			triggerUpdate("keyPressed");
+		}else if(args.key == 'p'){
+			settings.bShowProfilerOverlay = !settings.bShowProfilerOverlay;
+		}else if(args.key == 'z'){
+			if(undo()){
+				triggerUpdate("undo");
+			}
+		}else if(args.key == 'y'){
+			if(redo()){
+				triggerUpdate("redo");
+			}
 		}else if(args.key == 'n'){
 			currentPointToMove++;
 			if(currentPointToMove > curveVertices.size() + controlPoint1.size() + controlPoint2.size() - 1){
@@ -334,7 +390,8 @@ void ofxBezierUI::keyPressed(ofKeyEventArgs & args){
 			controlPoint1.pop_back();
 			controlPoint2.pop_back();
 
-			triggerUpdate();
+			recordHistory("keyPressed");
+			triggerUpdate("keyPressed");
 		}
 		if(args.key == OF_KEY_DEL){
 			// REMOVE last intermediate vertex added
@@ -342,7 +399,12 @@ void ofxBezierUI::keyPressed(ofKeyEventArgs & args){
 			controlPoint1.erase(controlPoint1.begin() + lastVertexSelected);
 			controlPoint2.erase(controlPoint2.begin() + lastVertexSelected);
 
-			triggerUpdate();
+			recordHistory("keyPressed");
+			triggerUpdate("keyPressed");
+		}
+		if(args.key == OF_KEY_UP || args.key == OF_KEY_DOWN || args.key == OF_KEY_LEFT || args.key == OF_KEY_RIGHT){
+			// nudges don't rebuild, but they are still a step to undo
+			recordHistory("keyPressed");
 		}
 	}
 }
@@ -374,8 +436,64 @@ void ofxBezierUI::unregisterFromEvents(){
 
 
 
-void ofxBezierUI::triggerUpdate(){
+void ofxBezierUI::insertVertexOnSegment(int segment, float t){
+	if(segment < 0 || segment >= segmentTree.getSegments().size()){
+		return;
+	}
+	const ofxBezierSegmentTree::Segment & s = segmentTree.getSegments()[segment];
+	glm::vec2 firstC1, firstC2, split, secondC1, secondC2;
+	ofxBezierUtility::SplitSegment(s.p0, s.c1, s.c2, s.p1, t, firstC1, firstC2, split, secondC1, secondC2);
+
+	// segment i ends at vertex i + 1, the closing segment ends at vertex 0 and its handles live in slot 0,
+	// so splitting it appends the new vertex after the last one
+	int index = segment + 1;
+
+	draggableVertex vtx;
+	vtx.pos = split;
+	draggableVertex cp1;
+	cp1.pos = firstC1;
+	draggableVertex cp2;
+	cp2.pos = firstC2;
+	curveVertices.insert(curveVertices.begin() + index, vtx);
+	controlPoint1.insert(controlPoint1.begin() + index, cp1);
+	controlPoint2.insert(controlPoint2.begin() + index, cp2);
+
+	// the vertex we split towards now gets the second half's handles
+	int next = (index + 1) % curveVertices.size();
+	controlPoint1.at(next).pos = secondC1;
+	controlPoint2.at(next).pos = secondC2;
+
+	currentPointToMove = index;
+	settings.currentPointToMove = index;
+	recordHistory("insertVertexOnSegment");
+}
+
+bool ofxBezierUI::undo(){
+	// points changed from code since the last record become their own step first
+	recordHistory("edit");
+	if(!history.undo(curveVertices, controlPoint1, controlPoint2, settings.bIsClosed)){
+		return false;
+	}
+	lastVertexSelected = std::min(lastVertexSelected, std::max((int)curveVertices.size() - 1, 0));
+	return true;
+}
+
+bool ofxBezierUI::redo(){
+	recordHistory("edit");
+	if(!history.redo(curveVertices, controlPoint1, controlPoint2, settings.bIsClosed)){
+		return false;
+	}
+	lastVertexSelected = std::min(lastVertexSelected, std::max((int)curveVertices.size() - 1, 0));
+	return true;
+}
+
+void ofxBezierUI::recordHistory(const std::string & label, bool bMergeable){
+	history.record(curveVertices, controlPoint1, controlPoint2, settings.bIsClosed, label, bMergeable);
+}
+
+void ofxBezierUI::triggerUpdate(const std::string & source, int mergedEvents){
 	TriggerUpdateEventArgs args;
-	// Set any necessary properties of args
+	args.source = source;
+	args.mergedEvents = mergedEvents;
 	ofNotifyEvent(triggerUpdateEvent, args, this);
 }
@@ -11,10 +11,14 @@
 #include "ofxBezierEditorSettings.h"
 #include "draggableVertex.h"
 #include "ofxBezierEvents.h"
+#include "ofxBezierSegmentTree.h"
+#include "ofxBezierHistory.h"
 
 class ofxBezierUI {
 	public:
 		ofxBezierUI(ofxBezierEditorSettings & settings,
+					const ofxBezierSegmentTree & segmentTree,
+					ofxBezierHistory & history,
 					std::vector <draggableVertex> & curveVertices,
 					std::vector <draggableVertex> & controlPoint1,
 					std::vector <draggableVertex> & controlPoint2);
@@ -47,6 +51,22 @@ class ofxBezierUI {
 			lastVertexSelected = v;
 		}
 
+		// Drag events received, and how many of them were merged into another one's update
+		size_t getDragEventCount(){
+			return dragEventCount;
+		}
+		size_t getMergedDragEventCount(){
+			return mergedDragEventCount;
+		}
+
+		// Splits a segment at t into two that trace the same curve, the new vertex is selected for moving
+		void insertVertexOnSegment(int segment, float t);
+
+		// Steps the points back or forward through the history, false if there is nothing to do.
+		// The geometry isn't rebuilt, the 'z' and 'y' keys and ofxBezierEditor::undo() do that.
+		bool undo();
+		bool redo();
+
 		// Event Handling
 		void setReactToMouseAndKeyEvents(bool b);
 		void registerToEvents();
@@ -64,9 +84,23 @@ class ofxBezierUI {
 		bool bfillBezier;
 
 		ofxBezierEditorSettings & settings;
+		const ofxBezierSegmentTree & segmentTree;
+		ofxBezierHistory & history;
 		std::vector <draggableVertex> & curveVertices;
 		std::vector <draggableVertex> & controlPoint1;
 		std::vector <draggableVertex> & controlPoint2;
-		void triggerUpdate();
+		void triggerUpdate(const std::string & source, int mergedEvents = 0);
+		// every edit records itself, mergeable ones (a drag) are folded into one step until the history is sealed
+		void recordHistory(const std::string & label, bool bMergeable = false);
+
+		// drags are applied once per frame, see mouseDragged
+		void onUpdate(ofEventArgs & args);
+		void applyPendingDrag();
+		glm::vec2 dragPosition;
+		int pendingDragEvents = 0;
+		size_t dragEventCount = 0;
+		size_t mergedDragEventCount = 0;
+		// the bounding box was dragged since the mouse was pressed, see mouseReleased
+		bool bTransformDragged = false;
 };
 
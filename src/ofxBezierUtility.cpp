@@ -24,47 +24,364 @@ void ofxBezierUtility::ReflectEndPoints(ofPolyline & _inLine, ofPolyline & _outL
 	_outLine.addVertex(reflectedLast);
 }
 
+namespace {
+	// Tangents at the vertices of line, halfway between the edges either side as ofPolyline has them.
+	// Repeated vertices are stepped over and the end points of open lines take the direction of their
+	// only edge, which used to need reflected end points.
+	void calculateVertexTangents(const ofPolyline & line, std::vector <glm::vec3> & vertexTangents){
+		const auto & vertices = line.getVertices();
+		int count = vertices.size();
+		bool closed = line.isClosed();
+		// edge k runs from vertex k to the next one, closed lines also have the edge back to the start
+		int edges = closed ? count : count - 1;
+		auto edge = [&](int k){
+			return vertices[(k + 1) % count] - vertices[k];
+		};
+		auto findEdge = [&](int k, int step){
+			for(int tries = 0; tries < edges; tries++, k += step){
+				if(k < 0 || k >= edges){
+					if(!closed){
+						break;
+					}
+					k = (k + edges) % edges;
+				}
+				glm::vec3 e = edge(k);
+				if(glm::length2(e) > 1e-12){
+					return glm::normalize(e);
+				}
+			}
+			return glm::vec3(0);
+		};
+		vertexTangents.resize(count);
+		for(int i = 0; i < count; i++){
+			glm::vec3 before = findEdge(i - 1, -1);
+			glm::vec3 after = findEdge(i, 1);
+			glm::vec3 sum = before + after;
+			vertexTangents[i] = (glm::length2(sum) > 1e-12) ? glm::normalize(sum) : (glm::length2(after) > 0 ? after : before);
+		}
+	}
+
+	glm::vec3 interpolateTangent(const std::vector <glm::vec3> & vertexTangents, int i, float t){
+		glm::vec3 tangent = glm::mix(vertexTangents[i], vertexTangents[i + 1], t);
+		return (glm::length2(tangent) > 0) ? glm::normalize(tangent) : vertexTangents[i];
+	}
+}
+
 void ofxBezierUtility::CalculateInterpolatedTangentsAndPoints(const ofPolyline & line, vector <ofVec3f> & points, vector <ofVec3f> & tangents, int _meshLengthPrecisionMultiplier){
-	for(int i = 1; i < line.size() - 1; i++){
+	if(line.size() < 2){
+		return;
+	}
+	std::vector <glm::vec3> vertexTangents;
+	calculateVertexTangents(line, vertexTangents);
+	for(int i = 0; i < line.size(); i++){
 		points.push_back(ofVec3f(line[i].x, line[i].y, 0));
-		ofVec2f tangent = line.getTangentAtIndex(i);
-		tangents.push_back(tangent);
-		if(i < line.size() - 2){
+		tangents.push_back(vertexTangents[i]);
+		if(i < line.size() - 1){
 			// Add intermediate points and tangents based on precisionMultiplier
 			for(int j = 1; j < _meshLengthPrecisionMultiplier; j++){
 				float t = static_cast <float>(j) / static_cast <float>(_meshLengthPrecisionMultiplier);
-				ofVec3f interpolatedPoint = line.getPointAtIndexInterpolated(i + t);
-				ofVec2f interpolatedTangent = line.getTangentAtIndexInterpolated(i + t);
-				points.push_back(interpolatedPoint);
-				tangents.push_back(interpolatedTangent);
+				glm::vec3 interpolatedPoint = glm::mix(line[i], line[i + 1], t);
+				points.push_back(ofVec3f(interpolatedPoint.x, interpolatedPoint.y, 0));
+				tangents.push_back(interpolateTangent(vertexTangents, i, t));
 			}
 		}
 	}
 }
 void ofxBezierUtility::CalculateInterpolatedTangentsNormalsAndPoints(const ofPolyline & line, vector <ofVec3f> & points, vector <ofVec3f> & tangents, vector <ofVec3f> & normals, int _meshLengthPrecisionMultiplier){
+	size_t first = tangents.size();
+	CalculateInterpolatedTangentsAndPoints(line, points, tangents, _meshLengthPrecisionMultiplier);
+	// same side as ofPolyline's normals, the tangent crossed with the default right vector (0, 0, -1)
+	for(size_t i = first; i < tangents.size(); i++){
+		normals.push_back(ofVec3f(tangents[i].y, -tangents[i].x, 0));
+	}
+}
 
-	for(int i = 1; i < line.size() - 1; i++){
-		points.push_back(ofVec3f(line[i].x, line[i].y, line[i].z));
-		tangents.push_back(line.getTangentAtIndex(i));
-		normals.push_back(line.getNormalAtIndex(i));
 
-		// Add intermediate points and tangents based on precisionMultiplier
-		if(i < line.size() - 2){
+namespace {
+	// samples on a line of this many segment steps map length back to t closely enough
+	const int segmentLengthTableSteps = 32;
 
-			for(int j = 1; j < _meshLengthPrecisionMultiplier; j++){
-				float t = float(j) / float(_meshLengthPrecisionMultiplier);
-				ofVec3f interpolatedPoint = line.getPointAtIndexInterpolated(i + t);
-				ofVec2f interpolatedTangent = line.getTangentAtIndexInterpolated(i + t);
-				ofVec2f interpolatedNormal = line.getNormalAtIndexInterpolated(i + t);
-
-				points.push_back(interpolatedPoint);
-				tangents.push_back(interpolatedTangent);
-				normals.push_back(interpolatedNormal);
+	float getTurnAngle(const glm::vec3 & before, const glm::vec3 & after){
+		return acos(ofClamp(glm::dot(before, after), -1, 1));
+	}
+
+	// Cumulative length at every vertex. Each radian the line turns at a vertex counts as curvatureWeight
+	// extra samples worth of length, half on the edge before it and half on the edge after, so the length
+	// stays linear along each edge and samples can be placed with a plain interpolation.
+	void calculateWeightedLengths(const std::vector <glm::vec3> & vertices, const std::vector <glm::vec3> & directions, bool closed,
+								  float spacing, float curvatureWeight, std::vector <float> & lengths){
+		int edges = directions.size();
+		lengths.assign(1, 0);
+		for(int k = 0; k < edges; k++){
+			float length = glm::distance(vertices[k], vertices[k + 1]);
+			if(curvatureWeight > 0){
+				float turn = 0;
+				if(k > 0 || closed){
+					turn += getTurnAngle(directions[(k + edges - 1) % edges], directions[k]);
+				}
+				if(k < edges - 1 || closed){
+					turn += getTurnAngle(directions[k], directions[(k + 1) % edges]);
+				}
+				length += curvatureWeight * spacing * turn * 0.5;
+			}
+			lengths.push_back(lengths.back() + length);
+		}
+	}
+
+	// How many equal steps to cut total into, at least one
+	int getSampleSteps(float total, float spacing){
+		return std::max(static_cast <int>(round(total / std::max(spacing, 0.001f))), 1);
+	}
+}
+
+void ofxBezierUtility::CalculateArcLengthTangentsAndPoints(const ofPolyline & line, vector <ofVec3f> & points, vector <ofVec3f> & tangents, float spacing, float curvatureWeight){
+	// repeated vertices have no direction, leave them out
+	std::vector <glm::vec3> vertices;
+	vertices.reserve(line.size() + 1);
+	for(const auto & vertex : line.getVertices()){
+		if(vertices.empty() || glm::distance2(vertex, vertices.back()) > 1e-12){
+			vertices.push_back(vertex);
+		}
+	}
+	if(vertices.size() < 2){
+		for(const auto & vertex : vertices){
+			points.push_back(vertex);
+			tangents.push_back(ofVec3f(1, 0, 0));
+		}
+		return;
+	}
+	// closed lines end where they started, like the tessellated ones
+	bool closed = line.isClosed();
+	if(closed && glm::distance2(vertices.front(), vertices.back()) > 1e-12){
+		vertices.push_back(vertices.front());
+	}
+
+	int edges = vertices.size() - 1;
+	std::vector <glm::vec3> directions(edges);
+	for(int k = 0; k < edges; k++){
+		directions[k] = glm::normalize(vertices[k + 1] - vertices[k]);
+	}
+
+	// vertex tangents halfway between the edges either side, as ofPolyline does it
+	std::vector <glm::vec3> vertexTangents(vertices.size());
+	for(int i = 0; i < vertices.size(); i++){
+		glm::vec3 before = (i > 0) ? directions[i - 1] : (closed ? directions[edges - 1] : directions[0]);
+		glm::vec3 after = (i < edges) ? directions[i] : (closed ? directions[0] : directions[edges - 1]);
+		glm::vec3 sum = before + after;
+		vertexTangents[i] = (glm::length2(sum) > 1e-12) ? glm::normalize(sum) : after;
+	}
+
+	std::vector <float> lengths;
+	calculateWeightedLengths(vertices, directions, closed, spacing, curvatureWeight, lengths);
+
+	int steps = getSampleSteps(lengths.back(), spacing);
+	points.reserve(points.size() + steps + 1);
+	tangents.reserve(tangents.size() + steps + 1);
+	int k = 0;
+	for(int s = 0; s <= steps; s++){
+		if(s == steps){
+			points.push_back(vertices.back());
+			tangents.push_back(vertexTangents.back());
+			break;
+		}
+		float target = lengths.back() * s / steps;
+		while(k < edges - 1 && lengths[k + 1] < target){
+			k++;
+		}
+		float edgeLength = lengths[k + 1] - lengths[k];
+		float f = (edgeLength > 0) ? ofClamp((target - lengths[k]) / edgeLength, 0, 1) : 0;
+		glm::vec3 tangent = glm::mix(vertexTangents[k], vertexTangents[k + 1], f);
+		points.push_back(glm::mix(vertices[k], vertices[k + 1], f));
+		tangents.push_back((glm::length2(tangent) > 1e-12) ? glm::normalize(tangent) : directions[k]);
+	}
+}
+
+void ofxBezierUtility::CalculateArcLengthTangentsNormalsAndPoints(const ofPolyline & line, vector <ofVec3f> & points, vector <ofVec3f> & tangents, vector <ofVec3f> & normals, float spacing, float curvatureWeight){
+	size_t first = tangents.size();
+	CalculateArcLengthTangentsAndPoints(line, points, tangents, spacing, curvatureWeight);
+	// same side as ofPolyline's normals, the tangent crossed with the default right vector (0, 0, -1)
+	for(size_t i = first; i < tangents.size(); i++){
+		normals.push_back(ofVec3f(tangents[i].y, -tangents[i].x, 0));
+	}
+}
+
+void ofxBezierUtility::CalculateSegmentTangentsAndPoints(const std::vector <ofxBezierSegmentTree::Segment> & segments, const ofxBezierMeshSettings & settings, vector <ofVec3f> & points, vector <ofVec3f> & tangents){
+	size_t first = points.size();
+	int steps = 20 * std::max(settings.meshLengthPrecisionMultiplier, 1);
+	std::vector <float> parameters;
+	for(const auto & segment : segments){
+		// a segment with all four points on top of each other has no direction
+		if(segment.p0 == segment.p1 && segment.c1 == segment.p0 && segment.c2 == segment.p0){
+			continue;
+		}
+		if(settings.bArcLengthSampling){
+			CalculateSegmentArcLengthParameters(segment.p0, segment.c1, segment.c2, segment.p1, settings.sampleSpacing, settings.curvatureWeight, parameters);
+		}else{
+			parameters.resize(steps + 1);
+			for(int k = 0; k <= steps; k++){
+				parameters[k] = k / static_cast <float>(steps);
 			}
 		}
+		int last = parameters.size() - 1;
+		for(int k = 0; k <= last; k++){
+			glm::vec2 tangent = EvaluateSegmentTangent(segment.p0, segment.c1, segment.c2, segment.p1, parameters[k]);
+			if(k == 0 && points.size() > first){
+				// the previous segment already ended here
+				glm::vec3 sum = glm::vec3(tangents.back()) + glm::vec3(tangent, 0);
+				if(glm::length2(sum) > 1e-12){
+					tangents.back() = glm::normalize(sum);
+				}
+				continue;
+			}
+			glm::vec2 point = (k == 0) ? segment.p0 : (k == last) ? segment.p1 : EvaluateSegment(segment.p0, segment.c1, segment.c2, segment.p1, parameters[k]);
+			points.push_back(ofVec3f(point.x, point.y, 0));
+			tangents.push_back(ofVec3f(tangent.x, tangent.y, 0));
+		}
+	}
+	// the start and end of a closed curve are the same point and get the same tangent
+	if(settings.bIsClosed && points.size() > first + 1){
+		glm::vec3 sum = glm::vec3(tangents[first]) + glm::vec3(tangents.back());
+		if(glm::length2(sum) > 1e-12){
+			tangents[first] = glm::normalize(sum);
+			tangents.back() = tangents[first];
+		}
 	}
 }
 
+void ofxBezierUtility::CalculateSegmentTangentsNormalsAndPoints(const std::vector <ofxBezierSegmentTree::Segment> & segments, const ofxBezierMeshSettings & settings, vector <ofVec3f> & points, vector <ofVec3f> & tangents, vector <ofVec3f> & normals){
+	size_t first = tangents.size();
+	CalculateSegmentTangentsAndPoints(segments, settings, points, tangents);
+	for(size_t i = first; i < tangents.size(); i++){
+		normals.push_back(ofVec3f(tangents[i].y, -tangents[i].x, 0));
+	}
+}
+
+void ofxBezierUtility::CalculateSegmentArcLengthParameters(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, float spacing, float curvatureWeight, std::vector <float> & parameters){
+	parameters.clear();
+	std::vector <glm::vec3> vertices;
+	std::vector <glm::vec3> directions;
+	std::vector <float> tableParameters;
+	for(int j = 0; j <= segmentLengthTableSteps; j++){
+		float t = j / static_cast <float>(segmentLengthTableSteps);
+		glm::vec3 vertex(EvaluateSegment(p0, c1, c2, p1, t), 0);
+		if(!vertices.empty() && glm::distance2(vertex, vertices.back()) <= 1e-12){
+			continue;
+		}
+		if(!vertices.empty()){
+			directions.push_back(glm::normalize(vertex - vertices.back()));
+		}
+		vertices.push_back(vertex);
+		tableParameters.push_back(t);
+	}
+	if(vertices.size() < 2){
+		parameters.push_back(0);
+		parameters.push_back(1);
+		return;
+	}
+	// the end points keep their parameters even if the last steps were too short to count
+	tableParameters.back() = 1;
+
+	std::vector <float> lengths;
+	calculateWeightedLengths(vertices, directions, false, spacing, curvatureWeight, lengths);
+
+	int steps = getSampleSteps(lengths.back(), spacing);
+	int edges = directions.size();
+	int k = 0;
+	for(int s = 0; s < steps; s++){
+		float target = lengths.back() * s / steps;
+		while(k < edges - 1 && lengths[k + 1] < target){
+			k++;
+		}
+		float edgeLength = lengths[k + 1] - lengths[k];
+		float f = (edgeLength > 0) ? ofClamp((target - lengths[k]) / edgeLength, 0, 1) : 0;
+		parameters.push_back(ofLerp(tableParameters[k], tableParameters[k + 1], f));
+	}
+	parameters.push_back(1);
+}
+
+
+float ofxBezierUtility::SimplifyPolyline(const ofPolyline & inLine, ofPolyline & outLine, float tolerance, float maxAngleDegrees){
+	const auto & in = inLine.getVertices();
+	outLine.clear();
+	outLine.setClosed(inLine.isClosed());
+	if(in.size() < 3 || tolerance <= 0){
+		outLine = inLine;
+		return 1.0;
+	}
+
+	// drop near duplicates first, they only produce degenerate tangents
+	float duplicateDistance = tolerance * 0.1;
+	std::vector <glm::vec3> points;
+	points.reserve(in.size());
+	for(int i = 0; i < in.size(); i++){
+		if(points.empty() || glm::distance(points.back(), in[i]) > duplicateDistance || i == in.size() - 1){
+			points.push_back(in[i]);
+		}
+	}
+
+	// the curvature guard, vertices where the line turns sharply are always kept
+	std::vector <bool> keep(points.size(), false);
+	keep.front() = true;
+	keep.back() = true;
+	float guardCos = cos(ofDegToRad(maxAngleDegrees));
+	for(int i = 1; i < points.size() - 1; i++){
+		glm::vec3 incoming = points[i] - points[i - 1];
+		glm::vec3 outgoing = points[i + 1] - points[i];
+		float lengths = glm::length(incoming) * glm::length(outgoing);
+		if(lengths > 0 && glm::dot(incoming, outgoing) / lengths < guardCos){
+			keep[i] = true;
+		}
+	}
+
+	// douglas peucker between each pair of kept vertices, with an explicit stack
+	float toleranceSquared = tolerance * tolerance;
+	std::vector <std::pair <int, int> > stack;
+	int start = 0;
+	for(int i = 1; i < points.size(); i++){
+		if(keep[i]){
+			stack.push_back(std::make_pair(start, i));
+			start = i;
+		}
+	}
+	while(!stack.empty()){
+		int first = stack.back().first;
+		int last = stack.back().second;
+		stack.pop_back();
+
+		glm::vec3 a = points[first];
+		glm::vec3 ab = points[last] - a;
+		float abLengthSquared = glm::dot(ab, ab);
+		float maxDistance = 0;
+		int index = -1;
+		for(int i = first + 1; i < last; i++){
+			glm::vec3 ap = points[i] - a;
+			float t = abLengthSquared > 0 ? ofClamp(glm::dot(ap, ab) / abLengthSquared, 0, 1) : 0;
+			float distance = glm::length2(ap - ab * t);
+			if(distance > maxDistance){
+				maxDistance = distance;
+				index = i;
+			}
+		}
+		if(index != -1 && maxDistance > toleranceSquared){
+			keep[index] = true;
+			stack.push_back(std::make_pair(first, index));
+			stack.push_back(std::make_pair(index, last));
+		}
+	}
+
+	int kept = 0;
+	for(int i = 0; i < points.size(); i++){
+		if(keep[i]){
+			outLine.addVertex(points[i]);
+			kept++;
+		}
+	}
+	// the mesh builders need a middle vertex
+	if(kept == 2 && points.size() > 2){
+		outLine.insertVertex(points[points.size() / 2], 1);
+	}
+	return float(in.size()) / float(outLine.size());
+}
 
 void ofxBezierUtility::CalculateLineLengths(const vector <ofVec3f> & points, std::vector <float> & segmentDistances,  float & totalLineLength, const bool _roundCap, float roundCapOffset){
 	if(_roundCap){
@@ -86,3 +403,119 @@ void ofxBezierUtility::CalculateLineLengths(const vector <ofVec3f> & points, std
 	}
 
 }
+
+glm::vec2 ofxBezierUtility::EvaluateSegment(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, float t){
+	float mt = 1.0 - t;
+	return p0 * (mt * mt * mt) + c1 * (3 * mt * mt * t) + c2 * (3 * mt * t * t) + p1 * (t * t * t);
+}
+
+glm::vec2 ofxBezierUtility::EvaluateSegmentTangent(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, float t){
+	float mt = 1.0 - t;
+	glm::vec2 derivative = (c1 - p0) * (3 * mt * mt) + (c2 - c1) * (6 * mt * t) + (p1 - c2) * (3 * t * t);
+	if(glm::length2(derivative) < 1e-12){
+		// degenerate handle, look a little way into the segment
+		float t0 = std::max(t - 0.01f, 0.0f);
+		float t1 = std::min(t + 0.01f, 1.0f);
+		derivative = EvaluateSegment(p0, c1, c2, p1, t1) - EvaluateSegment(p0, c1, c2, p1, t0);
+		if(glm::length2(derivative) < 1e-12){
+			derivative = p1 - p0;
+		}
+	}
+	float length = glm::length(derivative);
+	return length > 0 ? derivative / length : glm::vec2(1, 0);
+}
+
+ofRectangle ofxBezierUtility::GetSegmentBounds(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1){
+	glm::vec2 minimum = glm::min(p0, p1);
+	glm::vec2 maximum = glm::max(p0, p1);
+
+	// the derivative is a quadratic per axis, a t^2 + b t + c, its roots in (0, 1) are the extrema
+	glm::vec2 a = -p0 + c1 * 3.0f - c2 * 3.0f + p1;
+	glm::vec2 b = (p0 - c1 * 2.0f + c2) * 2.0f;
+	glm::vec2 c = c1 - p0;
+
+	for(int axis = 0; axis < 2; axis++){
+		// control points inside the end points' range can't push the curve out of it
+		if(c1[axis] >= minimum[axis] && c1[axis] <= maximum[axis] && c2[axis] >= minimum[axis] && c2[axis] <= maximum[axis]){
+			continue;
+		}
+		float roots[2];
+		int rootCount = 0;
+		if(fabs(a[axis]) < 1e-6){
+			if(fabs(b[axis]) > 1e-6){
+				roots[rootCount++] = -c[axis] / b[axis];
+			}
+		}else{
+			float discriminant = b[axis] * b[axis] - 4 * a[axis] * c[axis];
+			if(discriminant >= 0){
+				float root = sqrt(discriminant);
+				roots[rootCount++] = (-b[axis] + root) / (2 * a[axis]);
+				roots[rootCount++] = (-b[axis] - root) / (2 * a[axis]);
+			}
+		}
+		for(int i = 0; i < rootCount; i++){
+			if(roots[i] > 0 && roots[i] < 1){
+				float value = EvaluateSegment(p0, c1, c2, p1, roots[i])[axis];
+				minimum[axis] = std::min(minimum[axis], value);
+				maximum[axis] = std::max(maximum[axis], value);
+			}
+		}
+	}
+	return ofRectangle(minimum.x, minimum.y, maximum.x - minimum.x, maximum.y - minimum.y);
+}
+
+float ofxBezierUtility::ClosestPointOnSegment(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, const glm::vec2 & point, float & t){
+	const int samples = 8;
+	const int iterations = 5;
+
+	float bestT = 0;
+	float bestDistance = glm::distance2(p0, point);
+	for(int i = 1; i <= samples; i++){
+		float sampleT = float(i) / samples;
+		float distance = glm::distance2(EvaluateSegment(p0, c1, c2, p1, sampleT), point);
+		if(distance < bestDistance){
+			bestDistance = distance;
+			bestT = sampleT;
+		}
+	}
+
+	// first and second derivative control points
+	glm::vec2 d1[3] = { (c1 - p0) * 3.0f, (c2 - c1) * 3.0f, (p1 - c2) * 3.0f };
+	glm::vec2 d2[2] = { (d1[1] - d1[0]) * 2.0f, (d1[2] - d1[1]) * 2.0f };
+	float newtonT = bestT;
+	for(int i = 0; i < iterations; i++){
+		float mt = 1.0 - newtonT;
+		glm::vec2 diff = EvaluateSegment(p0, c1, c2, p1, newtonT) - point;
+		glm::vec2 q1 = d1[0] * mt * mt + d1[1] * 2.0f * mt * newtonT + d1[2] * newtonT * newtonT;
+		glm::vec2 q2 = d2[0] * mt + d2[1] * newtonT;
+		float denominator = glm::dot(q1, q1) + glm::dot(diff, q2);
+		if(denominator == 0){
+			break;
+		}
+		float step = glm::dot(diff, q1) / denominator;
+		newtonT = ofClamp(newtonT - step, 0, 1);
+		if(fabs(step) < 1e-6){
+			break;
+		}
+	}
+	// newton can wander off on loops and cusps, only keep it if it helped
+	float newtonDistance = glm::distance2(EvaluateSegment(p0, c1, c2, p1, newtonT), point);
+	if(newtonDistance < bestDistance){
+		bestDistance = newtonDistance;
+		bestT = newtonT;
+	}
+	t = bestT;
+	return sqrt(bestDistance);
+}
+
+void ofxBezierUtility::SplitSegment(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, float t,
+									glm::vec2 & firstC1, glm::vec2 & firstC2, glm::vec2 & split, glm::vec2 & secondC1, glm::vec2 & secondC2){
+	glm::vec2 q0 = glm::mix(p0, c1, t);
+	glm::vec2 q1 = glm::mix(c1, c2, t);
+	glm::vec2 q2 = glm::mix(c2, p1, t);
+	firstC1 = q0;
+	firstC2 = glm::mix(q0, q1, t);
+	secondC2 = q2;
+	secondC1 = glm::mix(q1, q2, t);
+	split = glm::mix(firstC2, secondC1, t);
+}
@@ -8,6 +8,8 @@
 #pragma once
 
 #include "ofMain.h" // or other necessary includes
+#include "ofxBezierMeshSettings.h"
+#include "ofxBezierSegmentTree.h"
 
 class ofxBezierUtility {
 	public:
@@ -17,6 +19,50 @@ class ofxBezierUtility {
 
 		static void CalculateInterpolatedTangentsNormalsAndPoints(const ofPolyline & line, vector <ofVec3f> & points, vector <ofVec3f> & tangents, vector <ofVec3f> & normals, int _meshLengthPrecisionMultiplier);
 
+		// Like the two above but the samples are spaced by length along the line instead of by polyline index,
+		// using a cumulative length table. The spacing is rounded so the last sample lands on the end point, and
+		// tangents blend between the vertex tangents either side. A curvatureWeight above 0 adds that many samples
+		// for every radian the line turns, so bends get denser than straight runs. No end point reflection needed.
+		static void CalculateArcLengthTangentsAndPoints(const ofPolyline & line, vector <ofVec3f> & points, vector <ofVec3f> & tangents, float spacing, float curvatureWeight);
+
+		static void CalculateArcLengthTangentsNormalsAndPoints(const ofPolyline & line, vector <ofVec3f> & points, vector <ofVec3f> & tangents, vector <ofVec3f> & normals, float spacing, float curvatureWeight);
+
+		// Samples taken straight from the cubic segments: the points are evaluated on the curve and the tangents
+		// come from its derivative, so they are exact and need no polyline at all. Every segment gets 20 samples
+		// times the precision multiplier, or is spaced by arc length when the settings ask for it. Where two
+		// segments meet both tangents are averaged. Closed curves end with the start point repeated.
+		static void CalculateSegmentTangentsAndPoints(const std::vector <ofxBezierSegmentTree::Segment> & segments, const ofxBezierMeshSettings & settings, vector <ofVec3f> & points, vector <ofVec3f> & tangents);
+
+		static void CalculateSegmentTangentsNormalsAndPoints(const std::vector <ofxBezierSegmentTree::Segment> & segments, const ofxBezierMeshSettings & settings, vector <ofVec3f> & points, vector <ofVec3f> & tangents, vector <ofVec3f> & normals);
+
+		// Parameters along a cubic segment spaced the same way, from 0 to 1 inclusive
+		static void CalculateSegmentArcLengthParameters(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, float spacing, float curvatureWeight, std::vector <float> & parameters);
+
+		// Ramer-Douglas-Peucker simplification. Vertices closer than tolerance to the simplified line are
+		// dropped, except where the line turns by more than maxAngleDegrees so tight bends keep their shape.
+		// Returns the reduction ratio, input vertex count over output vertex count.
+		static float SimplifyPolyline(const ofPolyline & inLine, ofPolyline & outLine, float tolerance, float maxAngleDegrees);
+
+		// Point on a cubic segment
+		static glm::vec2 EvaluateSegment(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, float t);
+
+		// Unit direction of a cubic segment at t, from its derivative. Where the derivative vanishes
+		// (a control point on top of its vertex) the direction of the curve nearby is used instead.
+		static glm::vec2 EvaluateSegmentTangent(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, float t);
+
+		// Tight bounds of a cubic segment, from the end points and the roots of its derivative.
+		// Unlike the control polygon or a tessellated line this is exact and does not depend on any resolution.
+		static ofRectangle GetSegmentBounds(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1);
+
+		// Distance from point to a cubic segment, t receives the parameter of the closest point.
+		// Coarse sampling finds the right basin, a few Newton steps on (B(t) - point) . B'(t) = 0 refine it.
+		static float ClosestPointOnSegment(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, const glm::vec2 & point, float & t);
+
+		// de Casteljau split at t. The first half is p0, firstC1, firstC2, split and the second
+		// is split, secondC1, secondC2, p1, together they trace exactly the same curve.
+		static void SplitSegment(const glm::vec2 & p0, const glm::vec2 & c1, const glm::vec2 & c2, const glm::vec2 & p1, float t,
+								 glm::vec2 & firstC1, glm::vec2 & firstC2, glm::vec2 & split, glm::vec2 & secondC1, glm::vec2 & secondC2);
+
 		static void CalculateLineLengths(const vector <ofVec3f> & points, std::vector <float> & segmentDistances,  float & totalLineLength, const bool _roundCap, float roundCapOffset);
 
 	private: